@@ -0,0 +1,178 @@
+//
+//  harness_bench.cc
+//  YCSB-C
+//
+//  What the harness costs without an engine behind it. First every key
+//  generator in ns/op, alone and shared by one std::thread per shard (each
+//  draw takes the generator's mutex, or that of the zipfian it skews, and
+//  skewed_latest also reads an atomic counter); then, with one client per shard
+//  against NullDB, the operations per second each shard can drive: loading,
+//  transactions called directly, and transactions each in its own
+//  seastar::async as ycsbc runs them.
+//
+//  Usage: harness_bench <seastar args> -- -P workloadfile [ycsbc options]
+//
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/client.h"
+#include "core/core_workload.h"
+#include "core/counter_generator.h"
+#include "core/discrete_generator.h"
+#include "core/scrambled_zipfian_generator.h"
+#include "core/skewed_latest_generator.h"
+#include "core/timer.h"
+#include "core/uniform_generator.h"
+#include "core/utils.h"
+#include "core/zipfian_generator.h"
+#include "db/null_db.h"
+#include "ycsbc.h"
+
+#include <seastar/core/app-template.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/core/thread.hh>
+
+using namespace std;
+using namespace ycsbc;
+
+namespace {
+
+template <class G>
+void BenchGenerator(const string &name, G &generator, size_t draws,
+                    unsigned threads) {
+  utils::Timer<double> timer;
+  volatile uint64_t sink = 0;
+  timer.Start();
+  for (size_t i = 0; i < draws; ++i) sink = generator.Next();
+  double alone = timer.End();
+
+  vector<thread> workers;
+  timer.Start();
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&generator, n = utils::ShareOf(draws, threads, t)] {
+      volatile uint64_t sink = 0;
+      for (int i = 0; i < n; ++i) sink = generator.Next();
+    });
+  }
+  for (thread &worker : workers) worker.join();
+  double shared = timer.End();
+
+  cout << name << '\t' << alone * 1e9 / draws << '\t'
+       << shared * 1e9 * threads / draws << endl;
+}
+
+void BenchGenerators(uint64_t items, size_t draws, unsigned threads) {
+  cout << "# generator\tns/op\tns/op with " << threads << " threads" << endl;
+  ZipfianGenerator zipfian(items);
+  BenchGenerator("zipfian", zipfian, draws, threads);
+  ScrambledZipfianGenerator scrambled(items);
+  BenchGenerator("scrambled_zipfian", scrambled, draws, threads);
+  CounterGenerator counter(items);
+  SkewedLatestGenerator latest(counter);
+  BenchGenerator("skewed_latest", latest, draws, threads);
+  DiscreteGenerator<uint64_t> discrete; // Shaped like the op chooser
+  discrete.AddValue(READ, 0.5);
+  discrete.AddValue(UPDATE, 0.3);
+  discrete.AddValue(INSERT, 0.1);
+  discrete.AddValue(SCAN, 0.1);
+  BenchGenerator("discrete", discrete, draws, threads);
+  UniformGenerator uniform(0, items - 1);
+  BenchGenerator("uniform", uniform, draws, threads);
+}
+
+enum Mode { kLoad, kDirect, kAsync };
+
+///
+/// Runs ops operations split over one client per shard and prints each
+/// shard's rate.
+///
+void BenchHarness(const string &name, Mode mode, DB &db, CoreWorkload &wl,
+                  int ops) {
+  const unsigned shards = seastar::smp::count;
+  vector<double> secs(shards);
+  vector<int> done(shards);
+  seastar::smp::invoke_on_all([&, mode, ops, shards] {
+    return seastar::async([&, mode, ops, shards] {
+      const int id = seastar::this_shard_id();
+      const int n = utils::ShareOf(ops, shards, id);
+      Client client(db, wl);
+      utils::Timer<double> timer;
+      timer.Start();
+      for (int i = 0; i < n; ++i) {
+        if (mode == kLoad) {
+          client.DoInsert(id).get();
+        } else if (mode == kDirect) {
+          client.DoTransaction(id).get();
+        } else {
+          seastar::async([&client, id] {
+            return client.DoTransaction(id).get();
+          }).get();
+        }
+      }
+      secs[id] = timer.End();
+      done[id] = n;
+    });
+  }).get();
+
+  double total = 0;
+  for (unsigned s = 0; s < shards; ++s) {
+    double rate = done[s] / secs[s];
+    cout << name << '\t' << s << '\t' << rate / 1000 << '\t'
+         << 1e9 / rate << endl;
+    total += rate;
+  }
+  cout << name << "\tall\t" << total / 1000 << '\t' << 1e9 * shards / total
+       << endl;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  vector<const char *> seastar_args, ycsbc_args;
+  seastar_args.push_back(argv[0]);
+  ycsbc_args.push_back(argv[0]);
+  bool sep_met = false;
+  for (int i = 1; i < argc; ++i) {
+    if (string(argv[i]) == "--") {
+      sep_met = true;
+    } else {
+      (sep_met ? ycsbc_args : seastar_args).push_back(argv[i]);
+    }
+  }
+  if (!sep_met) {
+    cerr << "Usage: " << argv[0] << " <seastar args> -- -P workloadfile"
+         << endl;
+    return 1;
+  }
+
+  seastar::app_template app;
+  return app.run(seastar_args.size(), const_cast<char **>(seastar_args.data()),
+                 [ycsbc_args] {
+    return seastar::async([ycsbc_args] {
+      utils::Properties props;
+      ParseCommandLine(ycsbc_args.size(),
+                       const_cast<const char **>(ycsbc_args.data()), props);
+      const unsigned shards = seastar::smp::count;
+      // One client per shard, with client id = shard id.
+      props.SetProperty("threadcount", to_string(shards));
+      CoreWorkload wl;
+      wl.Init(props);
+
+      const uint64_t records =
+          stoull(props[CoreWorkload::RECORD_COUNT_PROPERTY]);
+      const int ops = stoi(props[CoreWorkload::OPERATION_COUNT_PROPERTY]);
+      BenchGenerators(records, ops, shards);
+
+      NullDB db;
+      cout << "# harness\tshard\tKTPS\tns/op" << endl;
+      BenchHarness("load", kLoad, db, wl, stoi(props.GetProperty(
+          CoreWorkload::RECORD_COUNT_PROPERTY)));
+      BenchHarness("transaction", kDirect, db, wl, ops);
+      BenchHarness("transaction+async", kAsync, db, wl, ops);
+    });
+  });
+}
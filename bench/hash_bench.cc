@@ -0,0 +1,87 @@
+//
+//  hash_bench.cc
+//  YCSB-C
+//
+//  Speed and distribution of the lib/hash.h hashers on YCSB key shapes.
+//  Quality is reported as the chi-square of bucket counts over 2^16
+//  buckets taken from the low and the high bits (about 65535 for a uniform
+//  hash), plus the number of full 64-bit collisions. The share of keys over
+//  16 bytes tells which of WyHasher's paths a shape takes: ordered keys
+//  stay short, while hashed ones, the default, take the long path.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/timer.h"
+#include "core/utils.h"
+#include "lib/hash.h"
+
+using namespace std;
+
+namespace {
+
+const int kBucketBits = 16;
+
+double ChiSquare(const vector<uint64_t> &hashes, int shift) {
+  vector<uint64_t> buckets(1 << kBucketBits);
+  for (uint64_t h : hashes) ++buckets[(h >> shift) & ((1 << kBucketBits) - 1)];
+  double expected = double(hashes.size()) / buckets.size();
+  double chi = 0;
+  for (uint64_t n : buckets) chi += (n - expected) * (n - expected) / expected;
+  return chi;
+}
+
+template <class H>
+void Bench(const string &hasher, const string &shape,
+           const vector<string> &keys) {
+  vector<uint64_t> hashes(keys.size());
+  utils::Timer<double> timer;
+  timer.Start();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    hashes[i] = H::Hash(keys[i].data(), keys[i].size());
+  }
+  double secs = timer.End();
+
+  double chi_low = ChiSquare(hashes, 0);
+  double chi_high = ChiSquare(hashes, 64 - kBucketBits);
+  sort(hashes.begin(), hashes.end());
+  size_t collisions = hashes.size() -
+      (unique(hashes.begin(), hashes.end()) - hashes.begin());
+
+  size_t bytes = 0, long_keys = 0;
+  for (const string &key : keys) {
+    bytes += key.size();
+    long_keys += key.size() > 16;
+  }
+
+  cout << hasher << '\t' << shape << '\t' << double(bytes) / keys.size()
+       << '\t' << 100.0 * long_keys / keys.size() << '\t'
+       << secs * 1e9 / keys.size() << '\t' << chi_low << '\t' << chi_high
+       << '\t' << collisions << endl;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  const size_t num_keys = argc > 1 ? atol(argv[1]) : 4000000;
+
+  // The two key shapes CoreWorkload::BuildKeyName produces.
+  vector<string> ordered, hashed;
+  for (size_t i = 0; i < num_keys; ++i) {
+    ordered.push_back(string("user").append(to_string(i)));
+    hashed.push_back(string("user").append(to_string(utils::Hash(i))));
+  }
+
+  cout << "# hasher\tkeys\tmean bytes\t% over 16 bytes\tns/hash"
+          "\tchi2 low bits\tchi2 high bits\tcollisions" << endl;
+  Bench<vmp::SDBMHasher>("sdbm", "ordered", ordered);
+  Bench<vmp::WyHasher>("wyhash", "ordered", ordered);
+  Bench<vmp::SDBMHasher>("sdbm", "hashed", hashed);
+  Bench<vmp::WyHasher>("wyhash", "hashed", hashed);
+  return 0;
+}
@@ -0,0 +1,106 @@
+//
+//  table_bench.cc
+//  YCSB-C
+//
+//  Single-threaded microbenchmark of the lib/ tables on YCSB-shaped keys:
+//  heap bytes per record, inserts/sec and lookups/sec. The "+arena" and
+//  "+slab" rows store keys (and B+tree nodes) through lib/arena_alloc.h
+//  instead of malloc(). Each row runs in a thread of its own, so that it
+//  starts with empty per-thread free lists and arena chunks.
+//
+
+#include <malloc.h>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/timer.h"
+#include "core/utils.h"
+#include "lib/arena_alloc.h"
+#include "lib/btree_table.h"
+#include "lib/stl_hashtable.h"
+#include "lib/swiss_hashtable.h"
+
+using namespace std;
+
+namespace {
+
+size_t HeapInUse() {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;  // Large blocks are mmap()ed
+}
+
+template <class Table>
+void Bench(const string &name, const vector<string> &keys,
+           const vector<uint32_t> &lookups) {
+  size_t heap_before = HeapInUse();
+  Table *table = new Table;
+
+  utils::Timer<double> timer;
+  timer.Start();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    table->Insert(keys[i].c_str(), reinterpret_cast<void *>(i + 1));
+  }
+  double insert_secs = timer.End();
+  double bytes = HeapInUse() - heap_before;
+
+  size_t hits = 0;
+  timer.Start();
+  for (uint32_t i : lookups) {
+    hits += table->Get(keys[i].c_str()) != NULL;
+  }
+  double lookup_secs = timer.End();
+
+  cout << name << '\t' << bytes / keys.size() << '\t'
+       << keys.size() / insert_secs / 1000 << '\t'
+       << lookups.size() / lookup_secs / 1000 << '\t' << hits << endl;
+  delete table;
+}
+
+///
+/// Runs Bench<Table>() in a fresh thread: SlabAlloc's free lists and
+/// ThreadArena's chunks are thread_local, so a row run on the thread of an
+/// earlier one would reuse the blocks that row freed and not count them.
+///
+template <class Table>
+void BenchRow(const string &name, const vector<string> &keys,
+              const vector<uint32_t> &lookups) {
+  thread row([&] { Bench<Table>(name, keys, lookups); });
+  row.join();
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  const size_t num_records = argc > 1 ? atol(argv[1]) : 1000000;
+  const size_t num_lookups = argc > 2 ? atol(argv[2]) : 10000000;
+  // One malloc arena, so that mallinfo2() sees what every thread allocates
+  mallopt(M_ARENA_MAX, 1);
+
+  // Keys as CoreWorkload builds them with insertorder=hashed.
+  vector<string> keys;
+  keys.reserve(num_records);
+  for (size_t i = 0; i < num_records; ++i) {
+    keys.push_back(string("user").append(to_string(utils::Hash(i))));
+  }
+  mt19937 rng(0);
+  uniform_int_distribution<uint32_t> dist(0, num_records - 1);
+  vector<uint32_t> lookups(num_lookups);
+  for (uint32_t &i : lookups) i = dist(rng);
+
+  cout << "# ThreadArena chunks are never returned: the +arena and +slab "
+          "rows leak what they allocated, which later rows do not reuse"
+       << endl;
+  cout << "# table\tbytes/record\tinsert KOPS\tlookup KOPS\thits" << endl;
+  BenchRow<vmp::StlHashtable<void *>>("stl", keys, lookups);
+  BenchRow<vmp::StlHashtable<void *, ArenaAlloc>>("stl+arena", keys, lookups);
+  BenchRow<vmp::StlHashtable<void *, SlabAlloc>>("stl+slab", keys, lookups);
+  BenchRow<vmp::SwissHashtable<void *>>("swiss", keys, lookups);
+  BenchRow<vmp::BTreeTable<void *>>("btree", keys, lookups);
+  BenchRow<vmp::BTreeTable<void *, SlabAlloc>>("btree+slab", keys, lookups);
+  return 0;
+}
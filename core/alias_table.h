@@ -0,0 +1,80 @@
+//
+//  alias_table.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_ALIAS_TABLE_H_
+#define YCSB_C_ALIAS_TABLE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// Picks an index with probability proportional to its weight in O(1),
+/// with Vose's alias method: one uniform draw selects a column and a second
+/// chooses between the column's own index and its alias.
+///
+class AliasTable {
+ public:
+  explicit AliasTable(const std::vector<double> &weights);
+
+  size_t Next() const;
+  size_t size() const { return accept_.size(); }
+  ///
+  /// The probability of index i.
+  ///
+  double probability(size_t i) const { return probs_[i]; }
+
+ private:
+  std::vector<double> probs_;
+  std::vector<double> accept_;
+  std::vector<uint32_t> alias_;
+};
+
+inline AliasTable::AliasTable(const std::vector<double> &weights) {
+  const size_t n = weights.size();
+  double total = 0;
+  for (double w : weights) total += w;
+  if (n == 0 || total <= 0) throw utils::Exception("No weights to draw from");
+
+  probs_.resize(n);
+  accept_.resize(n);
+  alias_.resize(n);
+  // Pair every index below the mean weight with one above it
+  std::vector<double> scaled(n);
+  std::vector<uint32_t> small, large;
+  for (size_t i = 0; i < n; ++i) {
+    probs_[i] = weights[i] / total;
+    scaled[i] = probs_[i] * n;
+    (scaled[i] < 1 ? small : large).push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    uint32_t s = small.back(), l = large.back();
+    small.pop_back();
+    accept_[s] = scaled[s];
+    alias_[s] = l;
+    scaled[l] -= 1 - scaled[s];
+    if (scaled[l] < 1) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  for (uint32_t i : large) accept_[i] = 1, alias_[i] = i;
+  for (uint32_t i : small) accept_[i] = 1, alias_[i] = i;  // Rounding
+}
+
+inline size_t AliasTable::Next() const {
+  const size_t n = accept_.size();
+  const double u = utils::RandomDouble() * n;
+  const size_t i = std::min<size_t>(u, n - 1);
+  return u - i < accept_[i] ? i : alias_[i];
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_ALIAS_TABLE_H_
@@ -9,152 +9,326 @@
 #ifndef YCSB_C_CLIENT_H_
 #define YCSB_C_CLIENT_H_
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
 #include <string>
 #include "core_workload.h"
 #include "db.h"
+#include "retry_stats.h"
+#include "timer.h"
+#include "txn_stats.h"
 #include "utils.h"
 
 #include <seastar/core/future.hh>
+#include <seastar/core/sleep.hh>
 
 namespace ycsbc {
 
+///
+/// What an operation did, filled in for callers that log slow operations.
+///
+struct OpRecord {
+  Operation op = READ;
+  std::string key;    ///< The first key, for multi-reads
+  size_t length = 0;  ///< Bytes read or written, records scanned or keys read
+  int status = DB::kOK;
+};
+
 class Client {
  public:
-  Client(DB &db, CoreWorkload &wl) : db_(db), workload_(wl) {}
+  Client(DB &db, CoreWorkload &wl, TxnStats *txn_stats = NULL,
+         RetryStats *retry_stats = NULL)
+      : db_(db), workload_(wl), txn_stats_(txn_stats),
+        retry_stats_(retry_stats) {}
 
-  virtual seastar::future<bool> DoInsert(int id);
-  virtual seastar::future<bool> DoTransaction(int id);
+  virtual seastar::future<bool> DoInsert(int id, OpRecord *record = NULL);
+  virtual seastar::future<bool> DoTransaction(int id,
+                                              OpRecord *record = NULL);
 
   virtual ~Client() {}
 
  protected:
-  virtual int TransactionRead(int id);
-  virtual int TransactionReadModifyWrite(int id);
-  virtual int TransactionScan(int id);
-  virtual int TransactionUpdate(int id);
-  virtual int TransactionInsert(int id);
-  virtual int TransactionMultiRead(int id);
+  virtual int TransactionRead(int id, OpRecord *record);
+  virtual int TransactionReadModifyWrite(int id, OpRecord *record);
+  virtual int TransactionScan(int id, OpRecord *record);
+  virtual int TransactionUpdate(int id, OpRecord *record);
+  virtual int TransactionInsert(int id, OpRecord *record);
+  virtual int TransactionMultiRead(int id, OpRecord *record);
+  ///
+  /// Reads the keys of a multi-key transaction and updates the first
+  /// updates of them in one DB transaction.
+  ///
+  virtual int TransactionMultiKey(int id, OpRecord *record);
+  int AttemptMultiKey(const std::string &table,
+                      const std::vector<std::string> &keys, size_t updates);
+  ///
+  /// Runs attempt, which returns a DB status, until it succeeds or the
+  /// workload's retry policy gives up on the status, sleeping for the
+  /// backoff in between; the caller must be a seastar thread. Fills in the
+  /// attempts made, how many of them conflicted and the seconds the last
+  /// one took, if asked.
+  ///
+  template <typename Attempt>
+  int WithRetries(Attempt attempt, int *attempts = NULL,
+                  int *conflicts = NULL, double *last = NULL);
+  ///
+  /// Notes the key and length of an operation in record, if any.
+  ///
+  static void Note(OpRecord *record, const std::string &key, size_t length) {
+    if (!record) return;
+    record->key = key;
+    record->length = length;
+  }
+  static size_t Bytes(const std::vector<DB::KVPair> &values) {
+    size_t bytes = 0;
+    for (const DB::KVPair &pair : values) bytes += pair.second.size();
+    return bytes;
+  }
+  ///
+  /// Returns the values to write: the shard's packed record itself, or all
+  /// fields or one built into values.
+  ///
+  std::vector<DB::KVPair> &WriteValues(std::vector<DB::KVPair> &values,
+                                       bool all_fields);
 
   DB &db_;
   CoreWorkload &workload_;
+  TxnStats *txn_stats_;  ///< Where multi-key transactions are counted, or NULL
+  RetryStats *retry_stats_;  ///< Where retries are counted, or NULL
 };
 
-inline seastar::future<bool> Client::DoInsert(int id) {
+template <typename Attempt>
+int Client::WithRetries(Attempt attempt, int *attempts, int *conflicts,
+                        double *last) {
+  const RetryPolicy &policy = workload_.retry_policy();
+  utils::Timer<double> total, timer;
+  total.Start();
+  double first = 0, backoff = 0, took = 0;
+  int tries = 0, conflicted = 0;
+  int status;
+  while (true) {
+    timer.Start();
+    status = attempt();
+    took = timer.End();
+    if (++tries == 1) first = took;
+    conflicted += status == DB::kErrorConflict;
+    if (status == DB::kOK || tries >= policy.attempts(status)) break;
+    const double pause = policy.Backoff(status, tries);
+    seastar::sleep(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(pause))).get();
+    backoff += pause;
+  }
+  if (attempts) *attempts = tries;
+  if (conflicts) *conflicts = conflicted;
+  if (last) *last = took;
+  if (retry_stats_) {
+    retry_stats_->Add(tries, status != DB::kOK && policy.attempts(status) > 1,
+                      first, total.End(), backoff);
+  }
+  return status;
+}
+
+inline seastar::future<bool> Client::DoInsert(int id, OpRecord *record) {
   std::string key = workload_.NextSequenceKey(id);
   std::vector<DB::KVPair> pairs;
-  workload_.BuildValues(pairs);
-  return seastar::make_ready_future<bool>(db_.Insert(workload_.NextTable(), key, pairs).get() == DB::kOK);
+  std::vector<DB::KVPair> &values = WriteValues(pairs, true);
+  int status = db_.Insert(workload_.NextTable(), key, values).get();
+  if (record) {
+    Note(record, key, Bytes(values));
+    record->op = INSERT;
+    record->status = status;
+  }
+  return seastar::make_ready_future<bool>(status == DB::kOK);
 }
 
-inline seastar::future<bool> Client::DoTransaction(int id) {
+inline seastar::future<bool> Client::DoTransaction(int id,
+                                                   OpRecord *record) {
   int status = -1;
-  switch (workload_.NextOperation()) {
+  const Operation op = workload_.NextOperation();
+  switch (op) {
     case READ:
-      status = TransactionRead(id);
+      status = TransactionRead(id, record);
       break;
     case UPDATE:
-      status = TransactionUpdate(id);
+      status = TransactionUpdate(id, record);
       break;
     case INSERT:
-      status = TransactionInsert(id);
+      status = TransactionInsert(id, record);
       break;
     case SCAN:
-      status = TransactionScan(id);
+      status = TransactionScan(id, record);
       break;
     case READMODIFYWRITE:
-      status = TransactionReadModifyWrite(id);
+      status = TransactionReadModifyWrite(id, record);
       break;
     case MULTIREAD:
-      status = TransactionMultiRead(id);
+      status = TransactionMultiRead(id, record);
+      break;
+    case TRANSACTION:
+      status = TransactionMultiKey(id, record);
       break;
     default:
       throw utils::Exception("Operation request is not recognized!");
   }
   assert(status >= 0);
+  if (record) {
+    record->op = op;
+    record->status = status;
+  }
   return seastar::make_ready_future<bool>(status == DB::kOK);
 }
 
-inline int Client::TransactionRead(int id) {
+inline int Client::TransactionRead(int id, OpRecord *record) {
   const std::string &table = workload_.NextTable();
   const std::string &key = workload_.NextTransactionKey(id);
   std::vector<DB::KVPair> result;
+  int status;
   if (!workload_.read_all_fields()) {
     std::vector<std::string> fields;
     fields.push_back("field" + workload_.NextFieldName());
-    return db_.Read(table, key, &fields, result).get();
+    status = WithRetries([&] {
+      result.clear();
+      return db_.Read(table, key, &fields, result).get();
+    });
   } else {
-    return db_.Read(table, key, NULL, result).get();
+    status = WithRetries([&] {
+      result.clear();
+      return db_.Read(table, key, NULL, result).get();
+    });
   }
+  Note(record, key, Bytes(result));
+  return status;
 }
 
-inline int Client::TransactionReadModifyWrite(int id) {
+inline int Client::TransactionReadModifyWrite(int id, OpRecord *record) {
   const std::string &table = workload_.NextTable();
   const std::string &key = workload_.NextTransactionKey(id);
   std::vector<DB::KVPair> result;
-
+  std::vector<std::string> fields;
   if (!workload_.read_all_fields()) {
-    std::vector<std::string> fields;
     fields.push_back("field" + workload_.NextFieldName());
-    db_.Read(table, key, &fields, result).get();
-  } else {
-    db_.Read(table, key, NULL, result).get();
   }
 
-  std::vector<DB::KVPair> values;
-  if (workload_.write_all_fields()) {
-    workload_.BuildValues(values);
-  } else {
-    workload_.BuildUpdate(values);
-  }
-  return db_.Update(table, key, values).get();
+  std::vector<DB::KVPair> buffer;
+  std::vector<DB::KVPair> &values =
+      WriteValues(buffer, workload_.write_all_fields());
+  Note(record, key, Bytes(values));
+  // A retry reads again, as it would to modify the record anew
+  return WithRetries([&] {
+    result.clear();
+    db_.Read(table, key, fields.empty() ? NULL : &fields, result).get();
+    return db_.Update(table, key, values).get();
+  });
 }
 
-inline int Client::TransactionScan(int id) {
+inline int Client::TransactionScan(int id, OpRecord *record) {
   const std::string &table = workload_.NextTable();
   const std::string &key = workload_.NextTransactionKey(id);
   int len = workload_.NextScanLength();
   std::vector<std::vector<DB::KVPair>> result;
+  Note(record, key, len);
+  std::vector<std::string> fields;
   if (!workload_.read_all_fields()) {
-    std::vector<std::string> fields;
     fields.push_back("field" + workload_.NextFieldName());
-    return db_.Scan(table, key, len, &fields, result).get();
-  } else {
-    return db_.Scan(table, key, len, NULL, result).get();
   }
+  return WithRetries([&] {
+    result.clear();
+    return db_.Scan(table, key, len, fields.empty() ? NULL : &fields, result)
+        .get();
+  });
 }
 
-inline int Client::TransactionUpdate(int id) {
+inline int Client::TransactionUpdate(int id, OpRecord *record) {
   const std::string &table = workload_.NextTable();
   const std::string &key = workload_.NextTransactionKey(id);
-  std::vector<DB::KVPair> values;
-  if (workload_.write_all_fields()) {
-    workload_.BuildValues(values);
-  } else {
-    workload_.BuildUpdate(values);
-  }
-  return db_.Update(table, key, values).get();
+  std::vector<DB::KVPair> buffer;
+  std::vector<DB::KVPair> &values =
+      WriteValues(buffer, workload_.write_all_fields());
+  Note(record, key, Bytes(values));
+  return WithRetries([&] { return db_.Update(table, key, values).get(); });
 }
 
-inline int Client::TransactionInsert(int id) {
+inline int Client::TransactionInsert(int id, OpRecord *record) {
   const std::string &table = workload_.NextTable();
   const std::string &key = workload_.NextSequenceKey(id);
-  std::vector<DB::KVPair> values;
-  workload_.BuildValues(values);
+  std::vector<DB::KVPair> buffer;
+  std::vector<DB::KVPair> &values = WriteValues(buffer, true);
+  Note(record, key, Bytes(values));
+  // Not retried: its conflict means the key exists
   return db_.Insert(table, key, values).get();
 }
 
-inline int Client::TransactionMultiRead(int id) {
+inline std::vector<DB::KVPair> &Client::WriteValues(
+    std::vector<DB::KVPair> &values, bool all_fields) {
+  if (workload_.packed() && !workload_.lengths_per_write()) {
+    return workload_.PackedRecord();
+  }
+  if (all_fields) {
+    workload_.BuildValues(values);
+  } else {
+    workload_.BuildUpdate(values);
+  }
+  return values;
+}
+
+inline int Client::TransactionMultiRead(int id, OpRecord *record) {
   const std::string &table = workload_.NextTable();
-  int len = workload_.NextScanLength();
+  int len = workload_.NextMultiReadLength();
   const std::vector<std::string> &keys = workload_.NextTransactionMultiKey(len);
   std::vector<std::vector<DB::KVPair>> results;
+  if (!keys.empty()) Note(record, keys.front(), keys.size());
+  std::vector<std::string> fields;
   if (!workload_.read_all_fields()) {
-    std::vector<std::string> fields;
     fields.push_back("field" + workload_.NextFieldName());
-    return db_.MultiRead(table, keys, &fields, results).get();
-  } else {
-    return db_.MultiRead(table, keys, NULL, results).get();
   }
+  return WithRetries([&] {
+    results.clear();
+    return db_.MultiRead(table, keys, fields.empty() ? NULL : &fields,
+                         results).get();
+  });
+}
+
+inline int Client::TransactionMultiKey(int id, OpRecord *record) {
+  const std::string &table = workload_.NextTable();
+  const std::vector<std::string> keys = workload_.NextTransactionKeys();
+  const size_t updates =
+      std::min(workload_.transaction_updates(), keys.size());
+  if (!keys.empty()) Note(record, keys.front(), keys.size());
+  utils::Timer<double> total;
+  total.Start();
+  int attempts, conflicts;
+  double last;
+  const int status =
+      WithRetries([&] { return AttemptMultiKey(table, keys, updates); },
+                  &attempts, &conflicts, &last);
+  if (txn_stats_) {
+    txn_stats_->Add(attempts, conflicts, status, last, total.End());
+  }
+  return status;
+}
+
+inline int Client::AttemptMultiKey(const std::string &table,
+                                   const std::vector<std::string> &keys,
+                                   size_t updates) {
+  // Aborted, if it is not committed, when it goes out of scope
+  std::unique_ptr<DB::Transaction> txn = db_.Begin();
+  std::vector<std::string> field;
+  if (!workload_.read_all_fields()) field.push_back(workload_.NextFieldName());
+  for (const std::string &key : keys) {
+    std::vector<DB::KVPair> result;
+    int status = db_.TxnRead(txn.get(), table, key,
+                             field.empty() ? NULL : &field, result).get();
+    if (status != DB::kOK) return status;
+  }
+  for (size_t i = 0; i < updates; ++i) {
+    std::vector<DB::KVPair> buffer;
+    std::vector<DB::KVPair> &values =
+        WriteValues(buffer, workload_.write_all_fields());
+    int status = db_.TxnUpdate(txn.get(), table, keys[i], values).get();
+    if (status != DB::kOK) return status;
+  }
+  return db_.Commit(std::move(txn)).get();
 }
 
 }  // namespace ycsbc
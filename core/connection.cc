@@ -0,0 +1,67 @@
+//
+//  connection.cc
+//  YCSB-C
+//
+
+#include "connection.h"
+
+#include <optional>
+#include <utility>
+#include "utils.h"
+
+#include <seastar/core/loop.hh>
+
+using std::string;
+using utils::Connection;
+
+Connection::Connection(seastar::connected_socket socket)
+    : socket_(std::move(socket)), in_(socket_.input()),
+      out_(socket_.output()), writes_(seastar::make_ready_future<>()) {
+  socket_.set_nodelay(true);
+}
+
+Connection Connection::Connect(const string &host, uint16_t port) {
+  return Connection(seastar::connect(seastar::make_ipv4_address(
+      seastar::ipv4_addr(host, port))).get());
+}
+
+void Connection::Send(const string &line) {
+  writes_ = writes_.then([this, data = line + '\n'] {
+    return out_.write(data).then([this] { return out_.flush(); });
+  });
+}
+
+seastar::future<> Connection::Drain() {
+  return std::exchange(writes_, seastar::make_ready_future<>());
+}
+
+seastar::future<string> Connection::Receive() {
+  return seastar::repeat_until_value([this] {
+    size_t end = pending_.find('\n');
+    if (end != string::npos) {
+      string line = pending_.substr(0, end);
+      pending_.erase(0, end + 1);
+      return seastar::make_ready_future<std::optional<string>>(
+          std::move(line));
+    }
+    return in_.read().then([this](seastar::temporary_buffer<char> buf) {
+      if (buf.empty()) throw Exception("Connection closed by peer");
+      pending_.append(buf.get(), buf.size());
+      return std::optional<string>();
+    });
+  });
+}
+
+seastar::future<> Connection::Expect(const string &expected) {
+  return Receive().then([expected](string line) {
+    if (line != expected) {
+      throw Exception("Expected \"" + expected + "\", got \"" + line + "\"");
+    }
+  });
+}
+
+seastar::future<> Connection::Close() {
+  return Drain().finally([this] {
+    return out_.close().finally([this] { return in_.close(); });
+  });
+}
@@ -0,0 +1,63 @@
+//
+//  connection.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_CONNECTION_H_
+#define YCSB_C_CONNECTION_H_
+
+#include <cstdint>
+#include <string>
+
+#include <seastar/core/future.hh>
+#include <seastar/core/iostream.hh>
+#include <seastar/net/api.hh>
+
+namespace utils {
+
+///
+/// A TCP connection carrying newline-terminated text messages, used between
+/// the coordinator and its workers. It belongs to the shard that made it.
+///
+class Connection {
+ public:
+  explicit Connection(seastar::connected_socket socket);
+
+  ///
+  /// Connects to host (a dotted IPv4 address) and port; blocks the calling
+  /// seastar thread.
+  ///
+  static Connection Connect(const std::string &host, uint16_t port);
+
+  ///
+  /// Queues line for sending behind the lines queued before it. Needs no
+  /// seastar thread, so timers may call it; errors surface in Drain().
+  ///
+  void Send(const std::string &line);
+  ///
+  /// Resolves once every queued line has been sent.
+  ///
+  seastar::future<> Drain();
+  ///
+  /// Returns the next line without its newline, or throws
+  /// utils::Exception if the peer closed the connection.
+  ///
+  seastar::future<std::string> Receive();
+  ///
+  /// Receives a line and throws utils::Exception unless it is expected.
+  ///
+  seastar::future<> Expect(const std::string &expected);
+
+  seastar::future<> Close();
+
+ private:
+  seastar::connected_socket socket_;
+  seastar::input_stream<char> in_;
+  seastar::output_stream<char> out_;
+  std::string pending_;  ///< Received but not yet returned
+  seastar::future<> writes_;
+};
+
+} // utils
+
+#endif // YCSB_C_CONNECTION_H_
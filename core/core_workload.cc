@@ -8,11 +8,14 @@
 
 #include "core_workload.h"
 #include "const_generator.h"
+#include "histogram_generator.h"
 #include "scrambled_zipfian_generator.h"
 #include "skewed_latest_generator.h"
 #include "uniform_generator.h"
 #include "zipfian_generator.h"
 
+#include <algorithm>
+#include <fstream>
 #include <string>
 
 using std::string;
@@ -28,6 +31,17 @@ const string CoreWorkload::FIELD_LENGTH_DISTRIBUTION_PROPERTY =
     "field_len_dist";
 const string CoreWorkload::FIELD_LENGTH_DISTRIBUTION_DEFAULT = "constant";
 
+const string CoreWorkload::FIELD_LENGTH_HISTOGRAM_PROPERTY =
+    "field_len_histogram";
+
+const string CoreWorkload::RECORD_LAYOUT_PROPERTY = "recordlayout";
+const string CoreWorkload::RECORD_LAYOUT_DEFAULT = "fields";
+
+const string CoreWorkload::PACKED_HEADER_PROPERTY = "packed.header";
+const string CoreWorkload::PACKED_HEADER_DEFAULT = "true";
+
+const string CoreWorkload::PACKED_FIELD_NAME = "record";
+
 const string CoreWorkload::FIELD_LENGTH_PROPERTY = "fieldlength";
 const string CoreWorkload::FIELD_LENGTH_DEFAULT = "1000";
 
@@ -57,10 +71,18 @@ const string CoreWorkload::MULTIREAD_PROPORTION_PROPERTY =
     "multireadproportion";
 const string CoreWorkload::MULTIREAD_PROPORTION_DEFAULT = "0.0";
 
+const string CoreWorkload::TRANSACTION_PROPORTION_PROPERTY =
+    "transactionproportion";
+const string CoreWorkload::TRANSACTION_PROPORTION_DEFAULT = "0.0";
+
 const string CoreWorkload::REQUEST_DISTRIBUTION_PROPERTY =
     "requestdistribution";
 const string CoreWorkload::REQUEST_DISTRIBUTION_DEFAULT = "uniform";
 
+const string CoreWorkload::EMPIRICAL_FILE_PROPERTY = "empirical.file";
+const string CoreWorkload::EMPIRICAL_TAIL_PROPERTY = "empirical.tail";
+const string CoreWorkload::EMPIRICAL_TAIL_DEFAULT = "0";
+
 const string CoreWorkload::MAX_SCAN_LENGTH_PROPERTY = "maxscanlength";
 const string CoreWorkload::MAX_SCAN_LENGTH_DEFAULT = "50";
 
@@ -68,11 +90,32 @@ const string CoreWorkload::SCAN_LENGTH_DISTRIBUTION_PROPERTY =
     "scanlengthdistribution";
 const string CoreWorkload::SCAN_LENGTH_DISTRIBUTION_DEFAULT = "const";
 
+const string CoreWorkload::MULTIREAD_KEY_SELECTION_PROPERTY =
+    "multiread.keyselection";
+const string CoreWorkload::MULTIREAD_KEY_SELECTION_DEFAULT = "contiguous";
+
+const string CoreWorkload::MULTIREAD_MAX_BATCH_PROPERTY = "multiread.maxbatch";
+const string CoreWorkload::MULTIREAD_BATCH_DISTRIBUTION_PROPERTY =
+    "multiread.batchdistribution";
+
+const string CoreWorkload::TRANSACTION_READS_PROPERTY = "transaction.reads";
+const string CoreWorkload::TRANSACTION_READS_DEFAULT = "4";
+const string CoreWorkload::TRANSACTION_UPDATES_PROPERTY =
+    "transaction.updates";
+const string CoreWorkload::TRANSACTION_UPDATES_DEFAULT = "2";
+
+const string CoreWorkload::TRANSACTION_HOTSET_PROPERTY = "transaction.hotset";
+const string CoreWorkload::TRANSACTION_HOTSET_DEFAULT = "0";
+const string CoreWorkload::TRANSACTION_HOTFRACTION_PROPERTY =
+    "transaction.hotfraction";
+const string CoreWorkload::TRANSACTION_HOTFRACTION_DEFAULT = "1";
+
 const string CoreWorkload::INSERT_ORDER_PROPERTY = "insertorder";
 const string CoreWorkload::INSERT_ORDER_DEFAULT = "hashed";
 
 const string CoreWorkload::INSERT_START_PROPERTY = "insertstart";
 const string CoreWorkload::INSERT_START_DEFAULT = "0";
+const string CoreWorkload::INSERT_COUNT_PROPERTY = "insertcount";
 
 const string CoreWorkload::RECORD_COUNT_PROPERTY = "recordcount";
 const string CoreWorkload::OPERATION_COUNT_PROPERTY = "operationcount";
@@ -83,6 +126,8 @@ void CoreWorkload::Init(const utils::Properties &p) {
   field_count_ =
       std::stoi(p.GetProperty(FIELD_COUNT_PROPERTY, FIELD_COUNT_DEFAULT));
   field_len_generator_ = GetFieldLenGenerator(p);
+  field_len_histogram_ =
+      dynamic_cast<HistogramGenerator *>(field_len_generator_);
 
   double read_proportion = std::stod(
       p.GetProperty(READ_PROPORTION_PROPERTY, READ_PROPORTION_DEFAULT));
@@ -96,6 +141,8 @@ void CoreWorkload::Init(const utils::Properties &p) {
       READMODIFYWRITE_PROPORTION_PROPERTY, READMODIFYWRITE_PROPORTION_DEFAULT));
   double multiread_proportion = std::stod(p.GetProperty(
       MULTIREAD_PROPORTION_PROPERTY, MULTIREAD_PROPORTION_DEFAULT));
+  double transaction_proportion = std::stod(p.GetProperty(
+      TRANSACTION_PROPORTION_PROPERTY, TRANSACTION_PROPORTION_DEFAULT));
 
   record_count_ = std::stoi(p.GetProperty(RECORD_COUNT_PROPERTY));
   std::string request_dist = p.GetProperty(REQUEST_DISTRIBUTION_PROPERTY,
@@ -104,21 +151,40 @@ void CoreWorkload::Init(const utils::Properties &p) {
       p.GetProperty(MAX_SCAN_LENGTH_PROPERTY, MAX_SCAN_LENGTH_DEFAULT));
   std::string scan_len_dist = p.GetProperty(SCAN_LENGTH_DISTRIBUTION_PROPERTY,
                                             SCAN_LENGTH_DISTRIBUTION_DEFAULT);
-  int insert_start =
+  int max_batch_len = std::stoi(p.GetProperty(MULTIREAD_MAX_BATCH_PROPERTY,
+                                              std::to_string(max_scan_len)));
+  std::string batch_len_dist =
+      p.GetProperty(MULTIREAD_BATCH_DISTRIBUTION_PROPERTY, scan_len_dist);
+  std::string key_selection = p.GetProperty(MULTIREAD_KEY_SELECTION_PROPERTY,
+                                            MULTIREAD_KEY_SELECTION_DEFAULT);
+  insert_start_ =
       std::stoi(p.GetProperty(INSERT_START_PROPERTY, INSERT_START_DEFAULT));
+  insert_count_ = std::stoi(p.GetProperty(
+      INSERT_COUNT_PROPERTY, p.GetProperty(RECORD_COUNT_PROPERTY)));
 
   read_all_fields_ = utils::StrToBool(
       p.GetProperty(READ_ALL_FIELDS_PROPERTY, READ_ALL_FIELDS_DEFAULT));
   write_all_fields_ = utils::StrToBool(
       p.GetProperty(WRITE_ALL_FIELDS_PROPERTY, WRITE_ALL_FIELDS_DEFAULT));
 
+  const string layout =
+      p.GetProperty(RECORD_LAYOUT_PROPERTY, RECORD_LAYOUT_DEFAULT);
+  if (layout == "packed") {
+    // A blob is read and written whole
+    packed_ = true;
+    read_all_fields_ = true;
+    write_all_fields_ = true;
+  } else if (layout != "fields") {
+    throw utils::Exception("Unknown record layout: " + layout);
+  }
+
   if (p.GetProperty(INSERT_ORDER_PROPERTY, INSERT_ORDER_DEFAULT) == "hashed") {
     ordered_inserts_ = false;
   } else {
     ordered_inserts_ = true;
   }
 
-  key_generator_ = new CounterGenerator(insert_start);
+  key_generator_ = new CounterGenerator(insert_start_);
 
   if (read_proportion > 0) {
     op_chooser_.AddValue(READ, read_proportion);
@@ -138,6 +204,9 @@ void CoreWorkload::Init(const utils::Properties &p) {
   if (multiread_proportion > 0) {
     op_chooser_.AddValue(MULTIREAD, multiread_proportion);
   }
+  if (transaction_proportion > 0) {
+    op_chooser_.AddValue(TRANSACTION, transaction_proportion);
+  }
 
   insert_key_sequence_.Set(record_count_);
 
@@ -157,23 +226,55 @@ void CoreWorkload::Init(const utils::Properties &p) {
   } else if (request_dist == "latest") {
     key_chooser_ = new SkewedLatestGenerator(insert_key_sequence_);
 
+  } else if (request_dist == "empirical") {
+    const string file = p.GetProperty(EMPIRICAL_FILE_PROPERTY);
+    std::ifstream input(file);
+    if (!input) {
+      throw utils::Exception("Cannot open key popularity file: " + file);
+    }
+    key_chooser_ = new EmpiricalGenerator(
+        input, record_count_,
+        std::stod(p.GetProperty(EMPIRICAL_TAIL_PROPERTY,
+                                EMPIRICAL_TAIL_DEFAULT)));
+
   } else {
     throw utils::Exception("Unknown request distribution: " + request_dist);
   }
 
   field_chooser_ = new UniformGenerator(0, field_count_ - 1);
 
-  if (scan_len_dist == "uniform") {
-    scan_len_chooser_ = new UniformGenerator(1, max_scan_len);
-  } else if (scan_len_dist == "zipfian") {
-    scan_len_chooser_ = new ZipfianGenerator(1, max_scan_len);
-  } else if (scan_len_dist == "const") {
-    scan_len_chooser_ = new ConstGenerator(max_scan_len);
+  scan_len_chooser_ =
+      GetLengthGenerator(scan_len_dist, max_scan_len, "scan length");
+  batch_len_chooser_ =
+      GetLengthGenerator(batch_len_dist, max_batch_len, "multi-read batch");
+
+  if (key_selection == "independent") {
+    independent_multikeys_ = true;
+  } else if (key_selection == "contiguous") {
+    independent_multikeys_ = false;
   } else {
-    throw utils::Exception("Distribution not allowed for scan length: " +
-                           scan_len_dist);
+    throw utils::Exception("Unknown multi-read key selection: " +
+                           key_selection);
   }
 
+  txn_reads_ = std::stoul(
+      p.GetProperty(TRANSACTION_READS_PROPERTY, TRANSACTION_READS_DEFAULT));
+  txn_updates_ = std::stoul(p.GetProperty(TRANSACTION_UPDATES_PROPERTY,
+                                          TRANSACTION_UPDATES_DEFAULT));
+  if (txn_reads_ == 0 || txn_updates_ > txn_reads_) {
+    throw utils::Exception("transaction.reads must be positive and at "
+                           "least transaction.updates");
+  }
+  const uint64_t hot_set = std::stoull(
+      p.GetProperty(TRANSACTION_HOTSET_PROPERTY, TRANSACTION_HOTSET_DEFAULT));
+  if (hot_set > 0) {
+    hot_chooser_ = new UniformGenerator(
+        0, std::min<uint64_t>(hot_set, record_count_) - 1);
+    hot_fraction_ = std::stod(p.GetProperty(TRANSACTION_HOTFRACTION_PROPERTY,
+                                            TRANSACTION_HOTFRACTION_DEFAULT));
+  }
+  retry_policy_ = RetryPolicy(p);
+
   std::cout << "Generating keys..." << std::endl;
   int total_ops = stoi(p[ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY]);
   const int num_threads = stoi(p.GetProperty("threadcount", "1"));
@@ -181,7 +282,7 @@ void CoreWorkload::Init(const utils::Properties &p) {
   for (int i = 0; i < num_threads; i++)
   {
     seq_keys.emplace_back();
-    for (int i = 0; i < total_ops / num_threads; i++)
+    for (int j = 0; j < utils::ShareOf(insert_count_, num_threads, i); j++)
       seq_keys.back().push_back(NextSequenceKey0());
     seq_keys_cursor.push_back(0);
   }
@@ -189,10 +290,13 @@ void CoreWorkload::Init(const utils::Properties &p) {
   for (int i = 0; i < num_threads; i++)
   {
     txn_keys.emplace_back();
-    for (int i = 0; i < total_ops / num_threads; i++)
+    for (int j = 0; j < utils::ShareOf(total_ops, num_threads, i); j++)
       txn_keys.back().push_back(NextTransactionKey0());
     txn_keys_cursor.push_back(0);
   }
+  if (auto *empirical = dynamic_cast<EmpiricalGenerator *>(key_chooser_)) {
+    empirical->Report(std::cout);
+  }
 
   for (int i = 0; i < field_count_; ++i) {
     ycsbc::DB::KVPair pair;
@@ -201,10 +305,87 @@ void CoreWorkload::Init(const utils::Properties &p) {
     pair_values.push_back(pair);
   }
 
+  // Values sized per write, and packed records, are cut from these bytes
+  size_t max_len = field_len_histogram_ ? field_len_histogram_->max() : 0;
+  for (const ycsbc::DB::KVPair &pair : pair_values) {
+    max_len = std::max(max_len, pair.second.size());
+  }
+  if (packed_ || field_len_histogram_) {
+    value_bytes_.resize(max_len);
+    for (char &c : value_bytes_) c = utils::RandomPrintChar();
+  }
+  if (field_len_histogram_) {
+    std::cout << "Field lengths from " << p[FIELD_LENGTH_HISTOGRAM_PROPERTY]
+              << ": mean " << field_len_histogram_->Mean() << ", max "
+              << field_len_histogram_->max() << " bytes" << std::endl;
+  }
+
+  if (packed_) {
+    packed_header_ = utils::StrToBool(
+        p.GetProperty(PACKED_HEADER_PROPERTY, PACKED_HEADER_DEFAULT));
+    std::vector<uint64_t> lengths;
+    for (const ycsbc::DB::KVPair &pair : pair_values) {
+      lengths.push_back(pair.second.size());
+    }
+    Pack(lengths, packed_value_);
+    packed_records_.assign(seastar::smp::count, {});
+  }
+
   std::cout << "Keys generated..." << std::endl;
 
 }
 
+std::vector<std::string> CoreWorkload::LoadKeys(int part, int parts) const {
+  // The same keys, in total, as the sequence keys handed to the loaders.
+  uint64_t begin = insert_start_;
+  for (int i = 0; i < part; ++i) {
+    begin += utils::ShareOf(insert_count_, parts, i);
+  }
+  const int count = utils::ShareOf(insert_count_, parts, part);
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    keys.push_back(BuildKeyName(begin + i));
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+ycsbc::Generator<uint64_t> *CoreWorkload::GetLengthGenerator(
+    const string &dist, int max_len, const string &what) {
+  if (dist == "uniform") {
+    return new UniformGenerator(1, max_len);
+  } else if (dist == "zipfian") {
+    return new ZipfianGenerator(1, max_len);
+  } else if (dist == "const") {
+    return new ConstGenerator(max_len);
+  } else {
+    throw utils::Exception("Distribution not allowed for " + what + ": " +
+                           dist);
+  }
+}
+
+void CoreWorkload::Pack(const std::vector<uint64_t> &lengths,
+                        string &blob) const {
+  blob.clear();
+  if (packed_header_) {
+    const uint32_t count = lengths.size();
+    blob.append(reinterpret_cast<const char *>(&count), sizeof(count));
+    uint32_t end = 0;
+    for (uint64_t length : lengths) {
+      end += length;
+      blob.append(reinterpret_cast<const char *>(&end), sizeof(end));
+    }
+  }
+  for (uint64_t length : lengths) blob.append(value_bytes_, 0, length);
+}
+
+void CoreWorkload::ReportFieldLengths(std::ostream &out) const {
+  if (field_len_histogram_) {
+    field_len_histogram_->Report(out, "Field lengths generated");
+  }
+}
+
 ycsbc::Generator<uint64_t> *CoreWorkload::GetFieldLenGenerator(
     const utils::Properties &p) {
   string field_len_dist = p.GetProperty(FIELD_LENGTH_DISTRIBUTION_PROPERTY,
@@ -217,6 +398,13 @@ ycsbc::Generator<uint64_t> *CoreWorkload::GetFieldLenGenerator(
     return new UniformGenerator(1, field_len);
   } else if (field_len_dist == "zipfian") {
     return new ZipfianGenerator(1, field_len);
+  } else if (field_len_dist == "histogram") {
+    const string file = p.GetProperty(FIELD_LENGTH_HISTOGRAM_PROPERTY);
+    std::ifstream input(file);
+    if (!input) {
+      throw utils::Exception("Cannot open field length histogram: " + file);
+    }
+    return new HistogramGenerator(input);
   } else {
     throw utils::Exception("Unknown field length distribution: " +
                            field_len_dist);
@@ -224,11 +412,40 @@ ycsbc::Generator<uint64_t> *CoreWorkload::GetFieldLenGenerator(
 }
 
 void CoreWorkload::BuildValues(std::vector<ycsbc::DB::KVPair> &values) {
+  if (field_len_histogram_) {
+    std::vector<uint64_t> lengths(field_count_);
+    for (uint64_t &length : lengths) length = field_len_histogram_->Next();
+    values.clear();
+    if (packed_) {
+      values.emplace_back(PACKED_FIELD_NAME, string());
+      Pack(lengths, values.back().second);
+      return;
+    }
+    for (int i = 0; i < field_count_; ++i) {
+      values.emplace_back(pair_values[i].first,
+                          string(value_bytes_, 0, lengths[i]));
+    }
+    return;
+  }
+  if (packed_) {
+    values = PackedRecord();
+    return;
+  }
   values = pair_values;
 }
 
 void CoreWorkload::BuildUpdate(std::vector<ycsbc::DB::KVPair> &update) {
+  if (packed_) {
+    BuildValues(update);
+    return;
+  }
   thread_local static int now = 0;
+  if (field_len_histogram_) {
+    update.emplace_back(pair_values[now].first,
+                        string(value_bytes_, 0, field_len_histogram_->Next()));
+    now = (now + 1) % field_count_;
+    return;
+  }
   update.push_back(pair_values[now]);
   now = (now + 1) % field_count_;
 }
@@ -10,18 +10,25 @@
 #define YCSB_C_CORE_WORKLOAD_H_
 
 #include <seastar/core/smp.hh>
+#include <algorithm>
+#include <ostream>
 #include <string>
 #include <vector>
 #include "counter_generator.h"
 #include "db.h"
 #include "discrete_generator.h"
+#include "empirical_generator.h"
 #include "generator.h"
+#include "histogram_generator.h"
 #include "properties.h"
+#include "retry_policy.h"
 #include "utils.h"
 
 namespace ycsbc {
 
-enum Operation { INSERT, READ, UPDATE, SCAN, READMODIFYWRITE, MULTIREAD };
+enum Operation {
+  INSERT, READ, UPDATE, SCAN, READMODIFYWRITE, MULTIREAD, TRANSACTION
+};
 
 class CoreWorkload {
  public:
@@ -39,10 +46,32 @@ class CoreWorkload {
 
   ///
   /// The name of the property for the field length distribution.
-  /// Options are "uniform", "zipfian" (favoring short records), and "constant".
+  /// Options are "uniform", "zipfian" (favoring short records), "constant"
+  /// and "histogram" (read from FIELD_LENGTH_HISTOGRAM_PROPERTY's file, see
+  /// HistogramGenerator). Other distributions fix each field's length once;
+  /// a histogram draws it for every write, so that rare sizes show up.
   ///
   static const std::string FIELD_LENGTH_DISTRIBUTION_PROPERTY;
   static const std::string FIELD_LENGTH_DISTRIBUTION_DEFAULT;
+  static const std::string FIELD_LENGTH_HISTOGRAM_PROPERTY;
+
+  ///
+  /// The name of the property for how a record is handed to the DB.
+  /// Options are "fields" (a name/value pair per field) and "packed" (a
+  /// single pair named PACKED_FIELD_NAME whose value holds every field).
+  ///
+  static const std::string RECORD_LAYOUT_PROPERTY;
+  static const std::string RECORD_LAYOUT_DEFAULT;
+
+  ///
+  /// The name of the property for whether a packed record starts with the
+  /// number of fields and the end offset of each in the blob (uint32 each,
+  /// native byte order).
+  ///
+  static const std::string PACKED_HEADER_PROPERTY;
+  static const std::string PACKED_HEADER_DEFAULT;
+
+  static const std::string PACKED_FIELD_NAME;
 
   ///
   /// The name of the property for the length of a field in bytes.
@@ -102,13 +131,29 @@ class CoreWorkload {
   static const std::string MULTIREAD_PROPORTION_PROPERTY;
   static const std::string MULTIREAD_PROPORTION_DEFAULT;
 
+  ///
+  /// The name of the property for the proportion of multi-key
+  /// transactions, which read some keys and update some of them atomically.
+  ///
+  static const std::string TRANSACTION_PROPORTION_PROPERTY;
+  static const std::string TRANSACTION_PROPORTION_DEFAULT;
+
   ///
   /// The name of the property for the the distribution of request keys.
-  /// Options are "uniform", "zipfian" and "latest".
+  /// Options are "uniform", "zipfian", "latest" and "empirical".
   ///
   static const std::string REQUEST_DISTRIBUTION_PROPERTY;
   static const std::string REQUEST_DISTRIBUTION_DEFAULT;
 
+  ///
+  /// The names of the properties for the key popularity file of the
+  /// "empirical" distribution (see EmpiricalGenerator) and the fraction of
+  /// requests spread over the keys it does not rank.
+  ///
+  static const std::string EMPIRICAL_FILE_PROPERTY;
+  static const std::string EMPIRICAL_TAIL_PROPERTY;
+  static const std::string EMPIRICAL_TAIL_DEFAULT;
+
   ///
   /// The name of the property for the max scan length (number of records).
   ///
@@ -122,6 +167,42 @@ class CoreWorkload {
   static const std::string SCAN_LENGTH_DISTRIBUTION_PROPERTY;
   static const std::string SCAN_LENGTH_DISTRIBUTION_DEFAULT;
 
+  ///
+  /// The name of the property for how the keys of a multi-read are chosen.
+  /// Options are "contiguous" (a run of key numbers from one drawn key) and
+  /// "independent" (every key drawn from the request distribution).
+  ///
+  static const std::string MULTIREAD_KEY_SELECTION_PROPERTY;
+  static const std::string MULTIREAD_KEY_SELECTION_DEFAULT;
+
+  ///
+  /// The names of the properties for the max number of keys in a multi-read
+  /// and their distribution, with the same options as for scans. They
+  /// default to the scan length's.
+  ///
+  static const std::string MULTIREAD_MAX_BATCH_PROPERTY;
+  static const std::string MULTIREAD_BATCH_DISTRIBUTION_PROPERTY;
+
+  ///
+  /// The names of the properties for how many distinct keys a transaction
+  /// reads and how many of those it then updates.
+  ///
+  static const std::string TRANSACTION_READS_PROPERTY;
+  static const std::string TRANSACTION_READS_DEFAULT;
+  static const std::string TRANSACTION_UPDATES_PROPERTY;
+  static const std::string TRANSACTION_UPDATES_DEFAULT;
+
+  ///
+  /// The names of the properties for the hot set of transactions: the
+  /// number of keys in it (0 for none) and the fraction of transaction keys
+  /// drawn uniformly from it rather than from the request distribution.
+  /// The smaller the hot set, the more transactions conflict.
+  ///
+  static const std::string TRANSACTION_HOTSET_PROPERTY;
+  static const std::string TRANSACTION_HOTSET_DEFAULT;
+  static const std::string TRANSACTION_HOTFRACTION_PROPERTY;
+  static const std::string TRANSACTION_HOTFRACTION_DEFAULT;
+
   ///
   /// The name of the property for the order to insert records.
   /// Options are "ordered" or "hashed".
@@ -132,6 +213,13 @@ class CoreWorkload {
   static const std::string INSERT_START_PROPERTY;
   static const std::string INSERT_START_DEFAULT;
 
+  ///
+  /// The name of the property for how many records, from insertstart on,
+  /// this process loads. Defaults to recordcount; processes sharing one
+  /// store each load their own range.
+  ///
+  static const std::string INSERT_COUNT_PROPERTY;
+
   static const std::string RECORD_COUNT_PROPERTY;
   static const std::string OPERATION_COUNT_PROPERTY;
 
@@ -152,25 +240,82 @@ class CoreWorkload {
   virtual std::string NextTransactionKey(int id);  /// Used for transactions
 
   virtual std::vector<std::string> NextTransactionMultiKey(int len);
+  ///
+  /// The distinct keys of a multi-key transaction, of which the first
+  /// transaction_updates() are to be updated.
+  ///
+  virtual std::vector<std::string> NextTransactionKeys();
+  ///
+  /// The number of keys NextSequenceKey(id) yields before it wraps around.
+  ///
+  size_t NumSequenceKeys(int id) const { return seq_keys[id].size(); }
+  size_t insert_count() const { return insert_count_; }
+  ///
+  /// Starts every client's sequence and transaction keys over, so that one
+  /// workload can run several phases without generating its keys again.
+  ///
+  void ResetKeyCursors() {
+    std::fill(seq_keys_cursor.begin(), seq_keys_cursor.end(), 0);
+    std::fill(txn_keys_cursor.begin(), txn_keys_cursor.end(), 0);
+  }
+  ///
+  /// Returns the part-th of parts slices of the keys the load phase
+  /// inserts, sorted. Safe to call from several threads at once.
+  ///
+  std::vector<std::string> LoadKeys(int part, int parts) const;
   virtual Operation NextOperation() { return op_chooser_.Next(); }
   virtual std::string NextFieldName();
   virtual size_t NextScanLength() { return scan_len_chooser_->Next(); }
+  virtual size_t NextMultiReadLength() { return batch_len_chooser_->Next(); }
 
   bool read_all_fields() const { return read_all_fields_; }
   bool write_all_fields() const { return write_all_fields_; }
+  bool packed() const { return packed_; }
+  size_t transaction_updates() const { return txn_updates_; }
+  ///
+  /// How clients retry failed operations, from the retry.* properties.
+  ///
+  const RetryPolicy &retry_policy() const { return retry_policy_; }
+  ///
+  /// Whether every write draws its own field lengths, so that there is no
+  /// record to share between writes.
+  ///
+  bool lengths_per_write() const { return field_len_histogram_ != NULL; }
+  ///
+  /// This shard's packed record, built on its first use and then handed to
+  /// every write as is, so writes copy no values; callers must not modify
+  /// it. Only for fixed field lengths.
+  ///
+  std::vector<ycsbc::DB::KVPair> &PackedRecord();
+  ///
+  /// Prints the field lengths generated so far against their distribution,
+  /// if it is a histogram.
+  ///
+  void ReportFieldLengths(std::ostream &out) const;
 
   CoreWorkload()
       : field_count_(0),
         read_all_fields_(false),
         write_all_fields_(false),
+        packed_(false),
+        packed_header_(false),
         field_len_generator_(NULL),
+        field_len_histogram_(NULL),
         key_generator_(NULL),
         key_chooser_(NULL),
         field_chooser_(NULL),
         scan_len_chooser_(NULL),
+        batch_len_chooser_(NULL),
+        independent_multikeys_(false),
+        txn_reads_(0),
+        txn_updates_(0),
+        hot_chooser_(NULL),
+        hot_fraction_(0),
         insert_key_sequence_(3),
         ordered_inserts_(true),
-        record_count_(0) {}
+        record_count_(0),
+        insert_start_(0),
+        insert_count_(0) {}
 
   virtual ~CoreWorkload() {
     if (field_len_generator_) delete field_len_generator_;
@@ -178,27 +323,51 @@ class CoreWorkload {
     if (key_chooser_) delete key_chooser_;
     if (field_chooser_) delete field_chooser_;
     if (scan_len_chooser_) delete scan_len_chooser_;
+    if (batch_len_chooser_) delete batch_len_chooser_;
+    if (hot_chooser_) delete hot_chooser_;
   }
 
  protected:
   static Generator<uint64_t> *GetFieldLenGenerator(const utils::Properties &p);
-  std::string BuildKeyName(uint64_t key_num);
+  static Generator<uint64_t> *GetLengthGenerator(const std::string &dist,
+                                                 int max_len,
+                                                 const std::string &what);
+  std::string BuildKeyName(uint64_t key_num) const;
+  ///
+  /// Builds a packed record of fields of the given lengths into blob.
+  ///
+  void Pack(const std::vector<uint64_t> &lengths, std::string &blob) const;
 
   std::string table_name_;
   int field_count_;
   bool read_all_fields_;
   bool write_all_fields_;
+  bool packed_;
+  bool packed_header_;
   Generator<uint64_t> *field_len_generator_;
+  HistogramGenerator *field_len_histogram_;  ///< field_len_generator_ or NULL
   Generator<uint64_t> *key_generator_;
   DiscreteGenerator<Operation> op_chooser_;
   Generator<uint64_t> *key_chooser_;
   Generator<uint64_t> *field_chooser_;
   Generator<uint64_t> *scan_len_chooser_;
+  Generator<uint64_t> *batch_len_chooser_;
+  bool independent_multikeys_;
+  size_t txn_reads_;
+  size_t txn_updates_;
+  Generator<uint64_t> *hot_chooser_;  ///< NULL without a hot set
+  double hot_fraction_;
+  RetryPolicy retry_policy_;
   CounterGenerator insert_key_sequence_;
   bool ordered_inserts_;
   size_t record_count_;
+  uint64_t insert_start_;
+  size_t insert_count_;
 
   std::vector<ycsbc::DB::KVPair> pair_values;
+  std::string value_bytes_;
+  std::string packed_value_;
+  std::vector<std::vector<ycsbc::DB::KVPair>> packed_records_;  ///< Per shard
 
   std::vector<std::vector<std::string>> seq_keys;
   std::vector<int> seq_keys_cursor;
@@ -237,17 +406,43 @@ inline std::vector<std::string> CoreWorkload::NextTransactionMultiKey(int len) {
   uint64_t key_num;
   std::vector<std::string> keys;
   key_num = key_chooser_->Next();
-  for (int i = 0; i < len; i++) keys.push_back(BuildKeyName(key_num + i));
+  for (int i = 0; i < len; i++) {
+    keys.push_back(BuildKeyName(key_num));
+    key_num = independent_multikeys_ ? key_chooser_->Next() : key_num + 1;
+  }
   return keys;
 }
 
-inline std::string CoreWorkload::BuildKeyName(uint64_t key_num) {
+inline std::vector<std::string> CoreWorkload::NextTransactionKeys() {
+  std::vector<std::string> keys;
+  // Bounded, in case the distribution offers fewer distinct keys
+  for (size_t tries = 0; keys.size() < txn_reads_ && tries < 100 * txn_reads_;
+       ++tries) {
+    const bool hot =
+        hot_chooser_ && utils::RandomDouble() < hot_fraction_;
+    std::string key =
+        BuildKeyName(hot ? hot_chooser_->Next() : key_chooser_->Next());
+    if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+      keys.push_back(std::move(key));
+    }
+  }
+  return keys;
+}
+
+inline std::string CoreWorkload::BuildKeyName(uint64_t key_num) const {
   if (!ordered_inserts_) {
     key_num = utils::Hash(key_num);
   }
   return std::string("user").append(std::to_string(key_num));
 }
 
+inline std::vector<ycsbc::DB::KVPair> &CoreWorkload::PackedRecord() {
+  std::vector<ycsbc::DB::KVPair> &record =
+      packed_records_[seastar::this_shard_id()];
+  if (record.empty()) record.emplace_back(PACKED_FIELD_NAME, packed_value_);
+  return record;
+}
+
 inline std::string CoreWorkload::NextFieldName() {
   return std::string("field").append(std::to_string(field_chooser_->Next()));
 }
@@ -9,10 +9,13 @@
 #ifndef YCSB_C_DB_H_
 #define YCSB_C_DB_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <seastar/core/do_with.hh>
 #include <seastar/core/future.hh>
+#include <seastar/core/loop.hh>
 
 namespace ycsbc {
 
@@ -22,6 +25,26 @@ class DB {
   inline static const int kOK = 0;
   inline static const int kErrorNoData = 1;
   inline static const int kErrorConflict = 2;
+  /// A failure that may pass, such as a timeout or an overloaded server
+  inline static const int kErrorTransient = 3;
+
+  ///
+  /// A run of records for BulkLoad(), in ascending key order. Values are
+  /// built as the run is consumed, so a run never holds all of them.
+  ///
+  class RecordRun {
+   public:
+    ///
+    /// Fills in the next record, or returns false at the end of the run.
+    ///
+    virtual bool Next(std::string &key, std::vector<KVPair> &values) = 0;
+    ///
+    /// The number of records in the run.
+    ///
+    virtual size_t size() const = 0;
+    virtual ~RecordRun() {}
+  };
+
   ///
   /// Initializes any state for accessing this DB.
   /// Called once per DB client (thread); there is a single DB instance
@@ -108,10 +131,86 @@ class DB {
   /// @return Zero on success, a non-zero error code on error.
   ///
   virtual seastar::future<int> Delete(const std::string &table, const std::string &key) = 0;
+  ///
+  /// Loads a sorted run of new records, as the load phase does with
+  /// loadmode=bulk. Called once per shard, on that shard, between Init()
+  /// and Close(); runs of different shards may overlap in key range.
+  /// Engines that can ingest sorted data directly (SST-style) override
+  /// this; the default inserts the records one by one in key order.
+  ///
+  /// @param table The name of the table.
+  /// @param run The records to load.
+  /// @return The number of records loaded.
+  ///
+  virtual seastar::future<int> BulkLoad(const std::string &table,
+                                        RecordRun &run);
+
+  ///
+  /// What an engine keeps about a transaction between Begin() and
+  /// Commit(). Destroying one without committing it aborts it.
+  ///
+  class Transaction {
+   public:
+    virtual ~Transaction() {}
+  };
+  ///
+  /// Begins a transaction. Engines without transactions return null (the
+  /// default); TxnRead() and TxnUpdate() then run as plain reads and
+  /// updates, each taking effect at once, and Commit() has nothing to do.
+  ///
+  virtual std::unique_ptr<Transaction> Begin() { return nullptr; }
+  ///
+  /// Reads a record as part of txn; otherwise like Read().
+  ///
+  virtual seastar::future<int> TxnRead(Transaction *txn,
+                                       const std::string &table,
+                                       const std::string &key,
+                                       const std::vector<std::string> *fields,
+                                       std::vector<KVPair> &result) {
+    return Read(table, key, fields, result);
+  }
+  ///
+  /// Updates a record as part of txn, taking effect when txn commits;
+  /// otherwise like Update().
+  ///
+  virtual seastar::future<int> TxnUpdate(Transaction *txn,
+                                         const std::string &table,
+                                         const std::string &key,
+                                         std::vector<KVPair> &values) {
+    return Update(table, key, values);
+  }
+  ///
+  /// Commits txn atomically.
+  ///
+  /// @return Zero on success, or kErrorConflict if txn conflicted with
+  ///         another transaction and was aborted.
+  ///
+  virtual seastar::future<int> Commit(std::unique_ptr<Transaction> txn) {
+    return seastar::make_ready_future<int>(kOK);
+  }
 
   virtual ~DB() {}
 };
 
+inline seastar::future<int> DB::BulkLoad(const std::string &table,
+                                         RecordRun &run) {
+  return seastar::do_with(std::string(), std::vector<KVPair>(), 0,
+      [this, &table, &run](std::string &key, std::vector<KVPair> &values,
+                           int &loaded) {
+    return seastar::repeat([this, &table, &run, &key, &values, &loaded] {
+      values.clear();
+      if (!run.Next(key, values)) {
+        return seastar::make_ready_future<seastar::stop_iteration>(
+            seastar::stop_iteration::yes);
+      }
+      return Insert(table, key, values).then([&loaded](int status) {
+        loaded += (status == kOK);
+        return seastar::stop_iteration::no;
+      });
+    }).then([&loaded] { return loaded; });
+  });
+}
+
 }  // namespace ycsbc
 
 #endif  // YCSB_C_DB_H_
@@ -0,0 +1,194 @@
+//
+//  empirical_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_EMPIRICAL_GENERATOR_H_
+#define YCSB_C_EMPIRICAL_GENERATOR_H_
+
+#include "alias_table.h"
+#include "generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <seastar/core/smp.hh>
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// Draws key numbers with a measured popularity: how often the key of each
+/// rank is requested. Ranks are grouped in buckets of equal per-key weight,
+/// a bucket is picked in O(1) from an alias table and a rank uniformly
+/// within it, and the rank is scrambled onto the key space as by
+/// ScrambledZipfianGenerator, so that popular keys are spread out. Counts
+/// of the ranks drawn are kept per shard, to report the skew achieved.
+///
+class EmpiricalGenerator : public Generator<uint64_t> {
+ public:
+  ///
+  /// Reads either a rank-frequency curve, lines of a rank (from 1,
+  /// ascending) and the weight of each key from the previous line's rank
+  /// on, or a top-K list, lines of a key and its count, ranked by count.
+  /// The fraction tail of the requests goes uniformly to the ranks past the
+  /// last one given, up to num_items. '#' starts a comment.
+  ///
+  EmpiricalGenerator(std::istream &input, uint64_t num_items, double tail);
+
+  uint64_t Next();
+  uint64_t Last() { return last_.load(std::memory_order_relaxed); }
+
+  ///
+  /// Prints the share of the requests going to the most popular keys,
+  /// asked for and drawn so far on every shard.
+  ///
+  void Report(std::ostream &out) const;
+
+ private:
+  uint64_t Scramble(uint64_t rank) const {
+    return utils::FNVHash64(rank) % num_items_;
+  }
+  uint64_t Low(size_t bucket) const {
+    return bucket ? bounds_[bucket - 1] + 1 : 1;
+  }
+  ///
+  /// The share of weights, one per bucket, on the ranks up to top.
+  ///
+  double Share(const std::vector<double> &weights, uint64_t top) const;
+
+  struct alignas(64) Drawn {
+    std::vector<uint64_t> counts;
+  };
+
+  const uint64_t num_items_;
+  std::vector<uint64_t> bounds_;  ///< Last rank of each bucket
+  std::vector<double> weights_;   ///< Of each bucket
+  std::unique_ptr<AliasTable> buckets_;
+  std::vector<Drawn> drawn_;      ///< Per shard
+  std::atomic<uint64_t> last_;  ///< Drawn on any shard
+};
+
+inline EmpiricalGenerator::EmpiricalGenerator(std::istream &input,
+                                              uint64_t num_items, double tail)
+    : num_items_(num_items), last_(0) {
+  std::vector<double> key_counts;
+  std::string line;
+  while (std::getline(input, line)) {
+    line = utils::Trim(line.substr(0, line.find('#')));
+    if (line.empty()) continue;
+    std::istringstream fields(line);
+    std::string first;
+    double weight;
+    if (!(fields >> first >> weight) || weight < 0) {
+      throw utils::Exception("Bad key popularity line: " + line);
+    }
+    const bool is_rank =
+        first.find_first_not_of("0123456789") == std::string::npos;
+    if (!is_rank) {
+      key_counts.push_back(weight);
+    } else {
+      const uint64_t rank = std::stoull(first);
+      if (!key_counts.empty() || rank == 0 ||
+          (!bounds_.empty() && rank <= bounds_.back())) {
+        throw utils::Exception("Ranks not ascending from 1 at: " + line);
+      }
+      if (!bounds_.empty() && bounds_.back() >= num_items_) continue;
+      const uint64_t bound = std::min(rank, num_items_);
+      const uint64_t keys = bound - (bounds_.empty() ? 0 : bounds_.back());
+      weights_.push_back(weight * keys);
+      bounds_.push_back(bound);
+    }
+  }
+  if (!key_counts.empty()) {
+    if (!bounds_.empty()) {
+      throw utils::Exception("Key popularity mixes ranks and keys");
+    }
+    std::sort(key_counts.begin(), key_counts.end(), std::greater<double>());
+    for (double count : key_counts) {
+      if (bounds_.size() == num_items_) break;
+      bounds_.push_back(bounds_.size() + 1);
+      weights_.push_back(count);
+    }
+  }
+  if (bounds_.empty()) throw utils::Exception("Empty key popularity");
+
+  double given = 0;
+  for (double w : weights_) given += w;
+  if (tail > 0 && tail < 1 && bounds_.back() < num_items_) {
+    bounds_.push_back(num_items_);
+    weights_.push_back(given * tail / (1 - tail));
+  }
+  buckets_.reset(new AliasTable(weights_));
+
+  drawn_.resize(seastar::smp::count);
+  for (Drawn &drawn : drawn_) drawn.counts.assign(bounds_.size(), 0);
+}
+
+inline uint64_t EmpiricalGenerator::Next() {
+  const size_t b = buckets_->Next();
+  const uint64_t low = Low(b);
+  const uint64_t rank = std::min<uint64_t>(
+      low + uint64_t(utils::RandomDouble() * (bounds_[b] - low + 1)),
+      bounds_[b]);
+  ++drawn_[seastar::this_shard_id()].counts[b];
+  const uint64_t key = Scramble(rank - 1);
+  last_.store(key, std::memory_order_relaxed);
+  return key;
+}
+
+inline double EmpiricalGenerator::Share(const std::vector<double> &weights,
+                                        uint64_t top) const {
+  double total = 0, share = 0;
+  for (size_t b = 0; b < weights.size(); ++b) {
+    total += weights[b];
+    const uint64_t low = Low(b);
+    if (bounds_[b] <= top) {
+      share += weights[b];
+    } else if (low <= top) {
+      share += weights[b] * (top - low + 1) / (bounds_[b] - low + 1);
+    }
+  }
+  return total > 0 ? share / total : 0;
+}
+
+inline void EmpiricalGenerator::Report(std::ostream &out) const {
+  std::vector<double> counts(bounds_.size());
+  for (const Drawn &drawn : drawn_) {
+    for (size_t b = 0; b < counts.size(); ++b) counts[b] += drawn.counts[b];
+  }
+  std::vector<uint64_t> tops = {1, 10, 100, 1000};
+  for (double fraction : {0.01, 0.1}) {
+    const uint64_t top = num_items_ * fraction;
+    if (top > 0) tops.push_back(top);
+  }
+  std::sort(tops.begin(), tops.end());
+  tops.erase(std::unique(tops.begin(), tops.end()), tops.end());
+
+  out << "# Request share of the most popular keys" << std::endl;
+  out << "keys";
+  for (uint64_t top : tops) {
+    if (top <= num_items_) out << '\t' << top;
+  }
+  out << std::endl << "target";
+  for (uint64_t top : tops) {
+    if (top <= num_items_) out << '\t' << Share(weights_, top);
+  }
+  out << std::endl << "drawn";
+  for (uint64_t top : tops) {
+    if (top <= num_items_) out << '\t' << Share(counts, top);
+  }
+  out << std::endl;
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_EMPIRICAL_GENERATOR_H_
@@ -0,0 +1,136 @@
+//
+//  histogram.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_HISTOGRAM_H_
+#define YCSB_C_HISTOGRAM_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "utils.h"
+
+namespace utils {
+
+///
+/// Latency histogram that can be merged across processes: log-linear
+/// buckets of nanoseconds, kSubBuckets per power of two, so a percentile
+/// read from it is within 1/kSubBuckets of the exact one.
+///
+class Histogram {
+ public:
+  static const int kSubBits = 5;
+  static const uint64_t kSubBuckets = 1 << kSubBits;
+
+  Histogram() : count_(0), sum_ns_(0), max_ns_(0) { }
+
+  void Add(double seconds) {
+    uint64_t ns = seconds > 0 ? uint64_t(seconds * 1e9) : 0;
+    size_t b = Bucket(ns);
+    if (b >= buckets_.size()) buckets_.resize(b + 1);
+    ++buckets_[b];
+    ++count_;
+    sum_ns_ += ns;
+    if (ns > max_ns_) max_ns_ = ns;
+  }
+
+  void Merge(const Histogram &other) {
+    if (other.buckets_.size() > buckets_.size()) {
+      buckets_.resize(other.buckets_.size());
+    }
+    for (size_t b = 0; b < other.buckets_.size(); ++b) {
+      buckets_[b] += other.buckets_[b];
+    }
+    count_ += other.count_;
+    sum_ns_ += other.sum_ns_;
+    if (other.max_ns_ > max_ns_) max_ns_ = other.max_ns_;
+  }
+
+  uint64_t count() const { return count_; }
+  double Mean() const { return count_ ? sum_ns_ / 1e9 / count_ : 0; }
+  double Max() const { return max_ns_ / 1e9; }
+
+  ///
+  /// Returns, in seconds, the upper bound of the bucket holding the q-th
+  /// quantile (0 < q <= 1).
+  ///
+  double Percentile(double q) const {
+    uint64_t rank = q * count_;
+    if (rank >= count_) rank = count_ - 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < buckets_.size(); ++b) {
+      seen += buckets_[b];
+      if (seen > rank) return std::min(UpperBound(b), max_ns_) / 1e9;
+    }
+    return Max();
+  }
+
+  ///
+  /// One line: count, sum and max, then "bucket:count" for each non-empty
+  /// bucket.
+  ///
+  std::string Serialize() const {
+    std::ostringstream out;
+    out << count_ << ' ' << sum_ns_ << ' ' << max_ns_;
+    for (size_t b = 0; b < buckets_.size(); ++b) {
+      if (buckets_[b]) out << ' ' << b << ':' << buckets_[b];
+    }
+    return out.str();
+  }
+
+  static Histogram Parse(const std::string &line) {
+    Histogram h;
+    std::istringstream in(line);
+    if (!(in >> h.count_ >> h.sum_ns_ >> h.max_ns_)) {
+      throw Exception("Malformed histogram: " + line);
+    }
+    size_t b;
+    char colon;
+    uint64_t n;
+    while (in >> b >> colon >> n) {
+      if (colon != ':') throw Exception("Malformed histogram: " + line);
+      if (b >= h.buckets_.size()) h.buckets_.resize(b + 1);
+      h.buckets_[b] = n;
+    }
+    return h;
+  }
+
+ private:
+  static size_t Bucket(uint64_t ns) {
+    if (ns < kSubBuckets) return ns;
+    int shift = 63 - __builtin_clzll(ns) - kSubBits;
+    return (shift + 1) * kSubBuckets + ((ns >> shift) - kSubBuckets);
+  }
+
+  static uint64_t UpperBound(size_t b) {
+    if (b < kSubBuckets) return b;
+    int shift = b / kSubBuckets - 1;
+    return ((b % kSubBuckets + kSubBuckets + 1) << shift) - 1;
+  }
+
+  std::vector<uint64_t> buckets_;
+  uint64_t count_;
+  uint64_t sum_ns_;
+  uint64_t max_ns_;
+};
+
+///
+/// Prints a row of label, count, then the mean, median, 99th and 99.9th
+/// percentiles and max of h in microseconds.
+///
+inline void PrintLatencyRow(std::ostream &out, const std::string &label,
+                            const Histogram &h) {
+  out << label << '\t' << h.count() << '\t' << h.Mean() * 1e6;
+  for (double q : {0.5, 0.99, 0.999}) {
+    out << '\t' << (h.count() ? h.Percentile(q) * 1e6 : 0);
+  }
+  out << '\t' << h.Max() * 1e6 << std::endl;
+}
+
+} // utils
+
+#endif // YCSB_C_HISTOGRAM_H_
@@ -0,0 +1,166 @@
+//
+//  histogram_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_HISTOGRAM_GENERATOR_H_
+#define YCSB_C_HISTOGRAM_GENERATOR_H_
+
+#include "alias_table.h"
+#include "generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <seastar/core/smp.hh>
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// Draws sizes from an empirical distribution given as buckets, such as the
+/// value sizes of a production trace. A bucket is picked in O(1) from an
+/// alias table and a size uniformly within it. Counts of the sizes drawn
+/// are kept per shard, so that what was generated can be compared with what
+/// was asked for.
+///
+class HistogramGenerator : public Generator<uint64_t> {
+ public:
+  ///
+  /// Reads lines of a size and the fraction of sizes up to it, both
+  /// ascending; the last fraction counts as 1. A bucket covers the sizes
+  /// above the previous line's, from 1 for the first. '#' starts a comment.
+  ///
+  explicit HistogramGenerator(std::istream &input);
+
+  uint64_t Next();
+  uint64_t Last() { return last_.load(std::memory_order_relaxed); }
+
+  uint64_t max() const { return bounds_.back(); }
+  ///
+  /// The mean size of the distribution.
+  ///
+  double Mean() const;
+  ///
+  /// Prints the mean and percentiles of the sizes drawn so far on every
+  /// shard next to those of the distribution. Percentiles are the upper
+  /// bounds of their buckets.
+  ///
+  void Report(std::ostream &out, const std::string &what) const;
+
+ private:
+  uint64_t Low(size_t bucket) const {
+    return bucket ? bounds_[bucket - 1] + 1 : 1;
+  }
+  uint64_t Percentile(const std::vector<double> &weights, double q) const;
+
+  struct alignas(64) Drawn {
+    std::vector<uint64_t> counts;
+    uint64_t sum = 0;
+  };
+
+  std::vector<uint64_t> bounds_;  ///< Largest size of each bucket
+  std::vector<double> probs_;
+  std::unique_ptr<AliasTable> buckets_;
+  std::vector<Drawn> drawn_;      ///< Per shard
+  std::atomic<uint64_t> last_;  ///< Drawn on any shard
+};
+
+inline HistogramGenerator::HistogramGenerator(std::istream &input)
+    : last_(0) {
+  std::vector<double> cdf;
+  std::string line;
+  while (std::getline(input, line)) {
+    line = utils::Trim(line.substr(0, line.find('#')));
+    if (line.empty()) continue;
+    std::istringstream fields(line);
+    uint64_t bound;
+    double fraction;
+    if (!(fields >> bound >> fraction)) {
+      throw utils::Exception("Bad histogram line: " + line);
+    }
+    if (bound == 0 || (!bounds_.empty() && bound <= bounds_.back()) ||
+        (!cdf.empty() && fraction < cdf.back())) {
+      throw utils::Exception("Histogram not ascending at: " + line);
+    }
+    bounds_.push_back(bound);
+    cdf.push_back(fraction);
+  }
+  if (bounds_.empty() || cdf.back() <= 0) {
+    throw utils::Exception("Empty histogram");
+  }
+
+  const size_t n = bounds_.size();
+  probs_.resize(n);
+  for (size_t b = 0; b < n; ++b) {
+    probs_[b] = (cdf[b] - (b ? cdf[b - 1] : 0)) / cdf.back();
+  }
+  buckets_.reset(new AliasTable(probs_));
+
+  drawn_.resize(seastar::smp::count);
+  for (Drawn &drawn : drawn_) drawn.counts.assign(n, 0);
+}
+
+inline uint64_t HistogramGenerator::Next() {
+  const size_t b = buckets_->Next();
+  const uint64_t low = Low(b);
+  const uint64_t len = std::min<uint64_t>(
+      low + uint64_t(utils::RandomDouble() * (bounds_[b] - low + 1)),
+      bounds_[b]);
+  Drawn &drawn = drawn_[seastar::this_shard_id()];
+  ++drawn.counts[b];
+  drawn.sum += len;
+  last_.store(len, std::memory_order_relaxed);
+  return len;
+}
+
+inline double HistogramGenerator::Mean() const {
+  double mean = 0;
+  for (size_t b = 0; b < bounds_.size(); ++b) {
+    mean += probs_[b] * (Low(b) + bounds_[b]) / 2.0;
+  }
+  return mean;
+}
+
+inline uint64_t HistogramGenerator::Percentile(
+    const std::vector<double> &weights, double q) const {
+  double total = 0;
+  for (double w : weights) total += w;
+  double seen = 0;
+  for (size_t b = 0; b < weights.size(); ++b) {
+    seen += weights[b];
+    if (seen >= q * total) return bounds_[b];
+  }
+  return bounds_.back();
+}
+
+inline void HistogramGenerator::Report(std::ostream &out,
+                                       const std::string &what) const {
+  std::vector<double> counts(bounds_.size());
+  double n = 0, sum = 0;
+  for (const Drawn &drawn : drawn_) {
+    for (size_t b = 0; b < counts.size(); ++b) counts[b] += drawn.counts[b];
+    sum += drawn.sum;
+  }
+  for (double c : counts) n += c;
+  out << "# " << what << " (bytes)" << std::endl;
+  out << "\tcount\tmean\tp50\tp90\tp99\tp99.9" << std::endl;
+  out << "target\t-\t" << Mean();
+  for (double q : {0.5, 0.9, 0.99, 0.999}) out << '\t' << Percentile(probs_, q);
+  out << std::endl;
+  out << "drawn\t" << uint64_t(n) << '\t' << (n ? sum / n : 0);
+  for (double q : {0.5, 0.9, 0.99, 0.999}) {
+    out << '\t' << (n ? Percentile(counts, q) : 0);
+  }
+  out << std::endl;
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_HISTOGRAM_GENERATOR_H_
@@ -0,0 +1,161 @@
+//
+//  perf_counters.cc
+//  YCSB-C
+//
+
+#include "perf_counters.h"
+
+#include <asm/unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include <seastar/core/smp.hh>
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using utils::PerfCounters;
+
+const PerfCounters::Event PerfCounters::kEvents[kNumEvents] = {
+  { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+  { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+  { "llc-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+  { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+  { "dtlb-load-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+};
+
+PerfCounters::PerfCounters() : shards_(seastar::smp::count) {
+}
+
+PerfCounters::~PerfCounters() {
+  // The events belong to the shard threads, but their fds to the process.
+  for (Shard &shard : shards_) {
+    for (int fd : shard.fds) close(fd);
+  }
+}
+
+int PerfCounters::OpenEvent(const Event &event, int group_fd) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = event.type;
+  attr.config = event.config;
+  attr.disabled = (group_fd < 0); // Members follow their leader
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  int fd = syscall(__NR_perf_event_open, &attr, 0, -1, group_fd,
+                   PERF_FLAG_FD_CLOEXEC);
+  if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+    attr.exclude_kernel = 1;
+    fd = syscall(__NR_perf_event_open, &attr, 0, -1, group_fd,
+                 PERF_FLAG_FD_CLOEXEC);
+  }
+  return fd;
+}
+
+void PerfCounters::OpenShard(Shard &shard) {
+  for (int e = 0; e < kNumEvents; ++e) {
+    int fd = OpenEvent(kEvents[e], shard.leader);
+    if (fd < 0) continue;
+    if (shard.leader < 0) shard.leader = fd;
+    shard.fds.push_back(fd);
+    shard.events.push_back(e);
+  }
+}
+
+void PerfCounters::StartShard(Shard &shard) {
+  if (shard.leader < 0) return;
+  ioctl(shard.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(shard.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::StopShard(Shard &shard) {
+  memset(shard.counted, 0, sizeof(shard.counted));
+  if (shard.leader < 0) return;
+  ioctl(shard.leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  // nr, time_enabled, time_running, then one value per event
+  std::vector<uint64_t> data(3 + shard.fds.size());
+  ssize_t len = data.size() * sizeof(uint64_t);
+  if (read(shard.leader, data.data(), len) != len) return;
+  uint64_t enabled = data[1], running = data[2];
+  if (running == 0) return; // The group never got onto the PMU
+  // Scale up for the time the group was multiplexed out.
+  double scale = double(enabled) / running;
+  for (size_t i = 0; i < shard.fds.size(); ++i) {
+    int e = shard.events[i];
+    shard.counts[e] = data[3 + i] * scale;
+    shard.counted[e] = true;
+  }
+}
+
+seastar::future<> PerfCounters::Open() {
+  return seastar::smp::invoke_on_all([this] {
+    OpenShard(shards_[seastar::this_shard_id()]);
+  }).then([this] {
+    string missing;
+    for (int e = 0; e < kNumEvents; ++e) {
+      for (const Shard &shard : shards_) {
+        bool open = false;
+        for (int opened : shard.events) open |= (opened == e);
+        if (!open) {
+          missing += string(missing.empty() ? "" : ", ") + kEvents[e].name;
+          break;
+        }
+      }
+    }
+    if (!missing.empty()) {
+      cerr << "# Perf counters unsupported on some shards: " << missing
+           << endl;
+    }
+  });
+}
+
+seastar::future<> PerfCounters::Start() {
+  return seastar::smp::invoke_on_all([this] {
+    StartShard(shards_[seastar::this_shard_id()]);
+  });
+}
+
+seastar::future<> PerfCounters::Stop() {
+  return seastar::smp::invoke_on_all([this] {
+    StopShard(shards_[seastar::this_shard_id()]);
+  });
+}
+
+void PerfCounters::Report(const string &phase, uint64_t ops) const {
+  uint64_t totals[kNumEvents] = {};
+  bool counted[kNumEvents] = {};
+  for (const Shard &shard : shards_) {
+    for (int e = 0; e < kNumEvents; ++e) {
+      if (!shard.counted[e]) continue;
+      totals[e] += shard.counts[e];
+      counted[e] = true;
+    }
+  }
+
+  cout << "# " << phase << " counters per operation" << endl;
+  if (ops == 0) ops = 1;
+  bool any = false;
+  for (int e = 0; e < kNumEvents; ++e) {
+    if (!counted[e]) continue;
+    cout << kEvents[e].name << '\t' << std::fixed << std::setprecision(2)
+         << double(totals[e]) / ops << endl;
+    any = true;
+  }
+  if (counted[0] && counted[1] && totals[0]) {
+    cout << "ipc\t" << double(totals[1]) / totals[0] << endl;
+  }
+  if (!any) cout << "unavailable" << endl;
+  cout.unsetf(std::ios::floatfield);
+  cout << std::setprecision(6);
+}
@@ -0,0 +1,81 @@
+//
+//  perf_counters.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_PERF_COUNTERS_H_
+#define YCSB_C_PERF_COUNTERS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <seastar/core/future.hh>
+
+namespace utils {
+
+///
+/// Hardware counters of every seastar shard, read with perf_event_open(2).
+///
+/// Each shard counts its own thread with one event group, so the events of
+/// a shard are scheduled together and their ratios are consistent. Events
+/// that the CPU, the hypervisor or perf_event_paranoid rule out are left
+/// out of the group and reported as unsupported; kernel time is excluded
+/// when only user space may be counted. Counts cover the whole shard, the
+/// reactor's idle polling included.
+///
+class PerfCounters {
+ public:
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  ///
+  /// Opens the group of every shard and says on stderr which events could
+  /// not be opened.
+  ///
+  seastar::future<> Open();
+  ///
+  /// Resets and enables the counters of every shard.
+  ///
+  seastar::future<> Start();
+  ///
+  /// Disables the counters of every shard and reads them.
+  ///
+  seastar::future<> Stop();
+  ///
+  /// Prints the counts of the last Start()/Stop() interval divided by ops.
+  ///
+  void Report(const std::string &phase, uint64_t ops) const;
+
+ private:
+  struct Event {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+  };
+
+  static const int kNumEvents = 5;
+  static const Event kEvents[kNumEvents];
+
+  struct Shard {
+    int leader = -1;
+    std::vector<int> fds;
+    std::vector<int> events;  ///< Index into kEvents of each fd
+    uint64_t counts[kNumEvents] = {};
+    bool counted[kNumEvents] = {};
+  };
+
+  static int OpenEvent(const Event &event, int group_fd);
+  static void OpenShard(Shard &shard);
+  static void StartShard(Shard &shard);
+  static void StopShard(Shard &shard);
+
+  std::vector<Shard> shards_;
+};
+
+} // utils
+
+#endif // YCSB_C_PERF_COUNTERS_H_
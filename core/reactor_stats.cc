@@ -0,0 +1,125 @@
+//
+//  reactor_stats.cc
+//  YCSB-C
+//
+
+#include "reactor_stats.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <seastar/core/metrics_api.hh>
+#include <seastar/core/smp.hh>
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using utils::ReactorStats;
+
+const char *const ReactorStats::kMetricNames[kNumMetrics] = {
+  "reactor_cpu_busy_ms",
+  "reactor_tasks_processed",
+  "scheduler_time_spent_on_task_quota_violations_ms",
+  "smp_total_sent_messages",
+  "smp_total_received_messages",
+};
+
+ReactorStats::ReactorStats(double busy_threshold,
+                           std::chrono::microseconds stall_period,
+                           std::chrono::microseconds stall_threshold)
+    : busy_threshold_(busy_threshold), stall_period_(stall_period),
+      stall_threshold_(stall_threshold), shards_(seastar::smp::count) {
+}
+
+ReactorStats::Snapshot ReactorStats::Take() {
+  namespace mi = seastar::metrics::impl;
+  Snapshot snapshot;
+  auto values = mi::get_values();
+  const mi::metric_metadata &families = *values->metadata;
+  for (size_t f = 0; f < families.size(); ++f) {
+    for (int m = 0; m < kNumMetrics; ++m) {
+      if (families[f].mf.name != kMetricNames[m]) continue;
+      // Summed over labels: scheduling groups, peer shards.
+      for (const mi::metric_value &value : values->values[f]) {
+        if (value.type() == mi::data_type::HISTOGRAM) continue;
+        snapshot.values[m] += value.d();
+      }
+      snapshot.found[m] = true;
+    }
+  }
+  snapshot.time = Clock::now();
+  return snapshot;
+}
+
+void ReactorStats::Tick(Shard &shard) {
+  Clock::time_point now = Clock::now();
+  if (now - shard.last_tick > stall_period_ + stall_threshold_) {
+    ++shard.stalls;
+  }
+  shard.last_tick = now;
+}
+
+seastar::future<> ReactorStats::Start() {
+  return seastar::smp::invoke_on_all([this] {
+    Shard &shard = shards_[seastar::this_shard_id()];
+    shard.stalls = 0;
+    shard.stall_timer.reset(new seastar::timer<>([this, &shard] {
+      Tick(shard);
+    }));
+    shard.last_tick = Clock::now();
+    shard.stall_timer->arm_periodic(stall_period_);
+    shard.start = Take();
+  });
+}
+
+seastar::future<> ReactorStats::Stop() {
+  return seastar::smp::invoke_on_all([this] {
+    Shard &shard = shards_[seastar::this_shard_id()];
+    shard.stop = Take();
+    shard.stall_timer.reset(); // Timers live and die on their own shard
+  });
+}
+
+void ReactorStats::Report(const string &phase,
+                          const vector<int> &clients_of) const {
+  const int num_shards = shards_.size();
+  cout << "# " << phase << " reactor stats" << endl;
+  cout << "shard\tclients\tbusy %\ttasks\tquota violations (ms)\tstalls"
+          "\tsmp sent\tsmp received" << endl;
+  string bound;
+  for (int s = 0; s < num_shards; ++s) {
+    const Shard &shard = shards_[s];
+    const int clients = s < (int)clients_of.size() ? clients_of[s] : 0;
+    double delta[kNumMetrics];
+    for (int m = 0; m < kNumMetrics; ++m) {
+      delta[m] = shard.stop.values[m] - shard.start.values[m];
+    }
+    double wall_ms = std::chrono::duration<double, std::milli>(
+        shard.stop.time - shard.start.time).count();
+    double busy = wall_ms > 0 ? delta[kBusyMs] / wall_ms : 0;
+
+    cout << s << '\t' << clients;
+    for (int m = 0; m < kNumMetrics; ++m) {
+      cout << '\t';
+      if (!shard.stop.found[m]) {
+        cout << '-';
+      } else if (m == kBusyMs) {
+        cout << busy * 100;
+      } else {
+        cout << uint64_t(delta[m]);
+      }
+      if (m == kQuotaViolationMs) cout << '\t' << shard.stalls;
+    }
+    if (clients && shard.stop.found[kBusyMs] && busy >= busy_threshold_) {
+      cout << "\tCPU-bound";
+      bound += (bound.empty() ? "" : ",") + std::to_string(s);
+    }
+    cout << endl;
+  }
+  if (!bound.empty()) {
+    cout << "# Client shards " << bound << " were CPU-bound: the "
+         << phase << " phase measured the clients, not the engine" << endl;
+  }
+}
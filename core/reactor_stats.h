@@ -0,0 +1,88 @@
+//
+//  reactor_stats.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_REACTOR_STATS_H_
+#define YCSB_C_REACTOR_STATS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <seastar/core/future.hh>
+#include <seastar/core/timer.hh>
+
+namespace utils {
+
+///
+/// What the seastar reactor of every shard did during a phase: how busy it
+/// was, how many tasks it ran, how long tasks overran their quota, how
+/// often it stalled and how many cross-shard messages it exchanged.
+///
+/// Busy time, tasks, quota violations and messages come from the reactor's
+/// own metrics; a metric this seastar does not export is reported as "-".
+/// Stalls are counted with a timer on each shard that fires every
+/// stall_period and counts a stall whenever it fires stall_threshold late.
+///
+/// A shard that runs clients and is busier than busy_threshold is flagged:
+/// its clients cannot issue operations any faster, so the phase measured
+/// the client setup, not the engine.
+///
+class ReactorStats {
+ public:
+  ReactorStats(double busy_threshold, std::chrono::microseconds stall_period,
+               std::chrono::microseconds stall_threshold);
+
+  ReactorStats(const ReactorStats &) = delete;
+  ReactorStats &operator=(const ReactorStats &) = delete;
+
+  ///
+  /// Takes the starting snapshot and arms the stall timer on every shard.
+  ///
+  seastar::future<> Start();
+  ///
+  /// Takes the closing snapshot and disarms the stall timers.
+  ///
+  seastar::future<> Stop();
+  ///
+  /// Prints a row per shard for the last Start()/Stop() interval, shard i
+  /// having run clients[i] clients.
+  ///
+  void Report(const std::string &phase,
+              const std::vector<int> &clients) const;
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  enum Metric { kBusyMs, kTasks, kQuotaViolationMs, kSent, kReceived,
+                kNumMetrics };
+  static const char *const kMetricNames[kNumMetrics];
+
+  struct Snapshot {
+    Clock::time_point time;
+    double values[kNumMetrics] = {};
+    bool found[kNumMetrics] = {};
+  };
+
+  struct Shard {
+    Snapshot start, stop;
+    uint64_t stalls = 0;
+    Clock::time_point last_tick;
+    std::unique_ptr<seastar::timer<>> stall_timer;
+  };
+
+  static Snapshot Take();
+  void Tick(Shard &shard);
+
+  const double busy_threshold_;
+  const std::chrono::microseconds stall_period_;
+  const std::chrono::microseconds stall_threshold_;
+  std::vector<Shard> shards_;
+};
+
+} // utils
+
+#endif // YCSB_C_REACTOR_STATS_H_
@@ -0,0 +1,92 @@
+//
+//  retry_policy.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_RETRY_POLICY_H_
+#define YCSB_C_RETRY_POLICY_H_
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+
+#include "db.h"
+#include "properties.h"
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// How a client retries an operation that failed, per DB status: how many
+/// attempts it makes in all, and how long it backs off before each retry.
+/// The backoff doubles with every retry up to a cap and is drawn uniformly
+/// below it ("full jitter"), so that clients that conflicted with each
+/// other do not collide again in step.
+///
+class RetryPolicy {
+ public:
+  struct Rule {
+    int attempts = 1;        ///< Including the first
+    double backoff = 0;      ///< Seconds, the cap before the first retry
+    double max_backoff = 0;  ///< Seconds, the cap the doubling stops at
+  };
+
+  ///
+  /// Retries nothing.
+  ///
+  RetryPolicy() {}
+
+  ///
+  /// Reads retry.<status>.attempts, retry.<status>.backoff_us and
+  /// retry.<status>.max_backoff_us for each status: "conflict" (default
+  /// 10 attempts, 50 us, 5000 us), "transient" (the same) and "nodata"
+  /// (default 1 attempt, so not retried).
+  ///
+  explicit RetryPolicy(const utils::Properties &p) {
+    Read(p, DB::kErrorConflict, "conflict", "10");
+    Read(p, DB::kErrorTransient, "transient", "10");
+    Read(p, DB::kErrorNoData, "nodata", "1");
+  }
+
+  ///
+  /// The attempts to make in all at an operation failing with status.
+  ///
+  int attempts(int status) const {
+    auto it = rules_.find(status);
+    return it == rules_.end() ? 1 : it->second.attempts;
+  }
+
+  ///
+  /// The seconds to wait after the attempt-th attempt failed with status.
+  ///
+  double Backoff(int status, int attempt) const {
+    auto it = rules_.find(status);
+    if (it == rules_.end()) return 0;
+    const Rule &rule = it->second;
+    const double cap = std::min(rule.max_backoff,
+                                std::ldexp(rule.backoff, attempt - 1));
+    return std::min(utils::RandomDouble(), 1.0) * cap;
+  }
+
+ private:
+  void Read(const utils::Properties &p, int status, const std::string &name,
+            const std::string &attempts) {
+    const std::string prefix = "retry." + name + ".";
+    Rule rule;
+    rule.attempts = std::stoi(p.GetProperty(prefix + "attempts", attempts));
+    rule.backoff = std::stod(p.GetProperty(prefix + "backoff_us", "50")) / 1e6;
+    rule.max_backoff =
+        std::stod(p.GetProperty(prefix + "max_backoff_us", "5000")) / 1e6;
+    if (rule.attempts < 1) {
+      throw utils::Exception(prefix + "attempts must be at least 1");
+    }
+    rules_[status] = rule;
+  }
+
+  std::map<int, Rule> rules_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_RETRY_POLICY_H_
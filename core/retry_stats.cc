@@ -0,0 +1,52 @@
+//
+//  retry_stats.cc
+//  YCSB-C
+//
+
+#include "retry_stats.h"
+
+#include <iostream>
+
+#include <seastar/core/smp.hh>
+
+using std::endl;
+using std::string;
+using ycsbc::RetryStats;
+
+RetryStats::RetryStats() : shards_(seastar::smp::count) {}
+
+void RetryStats::Add(int attempts, bool gave_up, double first, double total,
+                     double backoff) {
+  Shard &shard = shards_[seastar::this_shard_id()];
+  ++shard.ops;
+  shard.retried += attempts > 1;
+  shard.retries += attempts - 1;
+  shard.gave_up += gave_up;
+  shard.backoff += backoff;
+  shard.first.Add(first);
+  shard.total.Add(total);
+}
+
+void RetryStats::Report(const string &phase) {
+  Shard sum;
+  for (Shard &shard : shards_) {
+    sum.ops += shard.ops;
+    sum.retried += shard.retried;
+    sum.retries += shard.retries;
+    sum.gave_up += shard.gave_up;
+    sum.backoff += shard.backoff;
+    sum.first.Merge(shard.first);
+    sum.total.Merge(shard.total);
+    shard = Shard();
+  }
+  if (!sum.retried) return;
+
+  std::cout << "# " << phase << " retries" << endl;
+  std::cout << "ops\tretried\tretries\tgave up\tbackoff (ms)" << endl;
+  std::cout << sum.ops << '\t' << sum.retried << '\t' << sum.retries << '\t'
+            << sum.gave_up << '\t' << sum.backoff * 1000 << endl;
+  std::cout << "# " << phase << " latency by attempt (us)" << endl;
+  std::cout << "\tcount\tmean\tp50\tp99\tp99.9\tmax" << endl;
+  utils::PrintLatencyRow(std::cout, "first attempt", sum.first);
+  utils::PrintLatencyRow(std::cout, "end to end", sum.total);
+}
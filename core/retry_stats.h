@@ -0,0 +1,58 @@
+//
+//  retry_stats.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_RETRY_STATS_H_
+#define YCSB_C_RETRY_STATS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "histogram.h"
+
+namespace ycsbc {
+
+///
+/// Counts, per shard, the operations of a phase under the retry policy:
+/// how many were retried or given up on and the time spent backing off,
+/// with their latency of the first attempt next to that end to end. The
+/// two differ by what retries cost, which a failed first attempt, often
+/// cheap, would otherwise hide.
+///
+class RetryStats {
+ public:
+  RetryStats();
+
+  ///
+  /// Records an operation of the calling shard that took attempts tries,
+  /// the first lasting first seconds and all of them, with backoff seconds
+  /// of waiting between, total seconds. gave_up is whether it ran out of
+  /// attempts.
+  ///
+  void Add(int attempts, bool gave_up, double first, double total,
+           double backoff);
+  ///
+  /// Prints the operations of the phase, then forgets them. Prints nothing
+  /// if none was retried. Call when no operations are running.
+  ///
+  void Report(const std::string &phase);
+
+ private:
+  struct alignas(64) Shard {
+    uint64_t ops = 0;
+    uint64_t retried = 0;
+    uint64_t retries = 0;
+    uint64_t gave_up = 0;
+    double backoff = 0;
+    utils::Histogram first;
+    utils::Histogram total;
+  };
+
+  std::vector<Shard> shards_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_RETRY_STATS_H_
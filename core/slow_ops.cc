@@ -0,0 +1,113 @@
+//
+//  slow_ops.cc
+//  YCSB-C
+//
+
+#include "slow_ops.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include <seastar/core/smp.hh>
+#include "utils.h"
+
+using std::endl;
+using std::string;
+using std::vector;
+using ycsbc::SlowOps;
+
+namespace {
+
+const char *OperationName(ycsbc::Operation op) {
+  switch (op) {
+    case ycsbc::INSERT: return "INSERT";
+    case ycsbc::READ: return "READ";
+    case ycsbc::UPDATE: return "UPDATE";
+    case ycsbc::SCAN: return "SCAN";
+    case ycsbc::READMODIFYWRITE: return "READMODIFYWRITE";
+    case ycsbc::MULTIREAD: return "MULTIREAD";
+    case ycsbc::TRANSACTION: return "TRANSACTION";
+  }
+  return "UNKNOWN";
+}
+
+} // namespace
+
+SlowOps::SlowOps(size_t top, double threshold, double sample, size_t max_log,
+                 const string &log_file)
+    : top_(top), threshold_(threshold), sample_(sample), max_log_(max_log),
+      log_file_(log_file), shards_(seastar::smp::count) {}
+
+void SlowOps::Add(const OpRecord &record, Time start, double latency) {
+  const unsigned id = seastar::this_shard_id();
+  Shard &shard = shards_[id];
+  if (top_ && (shard.top.size() < top_ || latency > shard.top[0].latency)) {
+    if (shard.top.size() == top_) {
+      std::pop_heap(shard.top.begin(), shard.top.end(), Faster);
+      shard.top.pop_back();
+    }
+    shard.top.push_back({start, latency, id, record});
+    std::push_heap(shard.top.begin(), shard.top.end(), Faster);
+  }
+  if (threshold_ > 0 && latency >= threshold_) {
+    ++shard.over;
+    if (shard.log.size() < max_log_ &&
+        (sample_ >= 1 || utils::RandomDouble() < sample_)) {
+      shard.log.push_back({start, latency, id, record});
+    }
+  }
+}
+
+void SlowOps::Print(std::ostream &out, const Entry &entry) {
+  out << std::chrono::duration_cast<std::chrono::microseconds>(
+             entry.start.time_since_epoch()).count()
+      << '\t' << entry.shard << '\t' << OperationName(entry.record.op)
+      << '\t' << entry.record.key << '\t' << entry.record.length << '\t'
+      << entry.record.status << '\t' << entry.latency * 1000 << endl;
+}
+
+void SlowOps::Report(const string &phase) {
+  const char *header = "start (us since epoch)\tshard\top\tkey\tlength"
+                       "\tstatus\tlatency (ms)";
+  if (top_) {
+    vector<Entry> top;
+    for (Shard &shard : shards_) {
+      top.insert(top.end(), shard.top.begin(), shard.top.end());
+      shard.top.clear();
+    }
+    std::sort(top.begin(), top.end(), Faster);
+    if (top.size() > top_) top.resize(top_);
+    std::cout << "# " << phase << " slowest operations" << endl;
+    std::cout << header << endl;
+    for (const Entry &entry : top) Print(std::cout, entry);
+  }
+
+  if (threshold_ > 0) {
+    vector<Entry> log;
+    uint64_t over = 0;
+    for (Shard &shard : shards_) {
+      log.insert(log.end(), shard.log.begin(), shard.log.end());
+      over += shard.over;
+      shard.log.clear();
+      shard.over = 0;
+    }
+    std::sort(log.begin(), log.end(), [](const Entry &a, const Entry &b) {
+      return a.start < b.start;
+    });
+    std::cout << "# " << phase << ": " << over << " operations over "
+              << threshold_ * 1000 << " ms, " << log.size() << " logged";
+    std::ofstream file;
+    if (!log_file_.empty()) {
+      file.open(log_file_, std::ios::app);
+      if (!file) throw utils::Exception("Cannot open " + log_file_);
+      std::cout << " to " << log_file_;
+    }
+    std::cout << endl;
+    std::ostream &out = log_file_.empty() ? std::cout : file;
+    out << "# " << phase << " operations over " << threshold_ * 1000
+        << " ms" << endl;
+    out << header << endl;
+    for (const Entry &entry : log) Print(out, entry);
+  }
+}
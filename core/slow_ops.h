@@ -0,0 +1,78 @@
+//
+//  slow_ops.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_SLOW_OPS_H_
+#define YCSB_C_SLOW_OPS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "client.h"
+
+namespace ycsbc {
+
+///
+/// Keeps, per shard, the slowest operations and a sampled log of those
+/// slower than a threshold, so that tail latency can be traced to keys,
+/// operation types and times. Each shard only touches its own entries, and
+/// an operation below both bars costs a comparison or two.
+///
+class SlowOps {
+ public:
+  typedef std::chrono::system_clock::time_point Time;
+
+  ///
+  /// @param top How many of the slowest operations each shard keeps.
+  /// @param threshold Latency in seconds above which operations are logged,
+  ///        or 0 to log none.
+  /// @param sample The fraction of those to log.
+  /// @param max_log How many each shard logs at most per phase.
+  /// @param log_file Where to write the log; stdout if empty.
+  ///
+  SlowOps(size_t top, double threshold, double sample, size_t max_log,
+          const std::string &log_file);
+
+  ///
+  /// Considers an operation of the calling shard that started at start and
+  /// took latency seconds.
+  ///
+  void Add(const OpRecord &record, Time start, double latency);
+  ///
+  /// Prints the slowest operations of the phase and writes its log, then
+  /// forgets both. Call when no operations are running.
+  ///
+  void Report(const std::string &phase);
+
+ private:
+  struct Entry {
+    Time start;
+    double latency;
+    unsigned shard;
+    OpRecord record;
+  };
+  struct Shard {
+    std::vector<Entry> top;  ///< A min-heap on latency
+    std::vector<Entry> log;
+    uint64_t over = 0;       ///< Operations over the threshold
+  };
+
+  static bool Faster(const Entry &a, const Entry &b) {
+    return a.latency > b.latency;
+  }
+  static void Print(std::ostream &out, const Entry &entry);
+
+  const size_t top_;
+  const double threshold_;
+  const double sample_;
+  const size_t max_log_;
+  const std::string log_file_;
+  std::vector<Shard> shards_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_SLOW_OPS_H_
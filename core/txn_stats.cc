@@ -0,0 +1,54 @@
+//
+//  txn_stats.cc
+//  YCSB-C
+//
+
+#include "txn_stats.h"
+
+#include <iostream>
+
+#include <seastar/core/smp.hh>
+#include "db.h"
+
+using std::endl;
+using std::string;
+using ycsbc::TxnStats;
+
+TxnStats::TxnStats() : shards_(seastar::smp::count) {}
+
+void TxnStats::Add(int attempts, int conflicts, int status, double last,
+                   double total) {
+  Shard &shard = shards_[seastar::this_shard_id()];
+  ++shard.txns;
+  shard.commits += status == DB::kOK;
+  shard.attempts += attempts;
+  shard.conflicts += conflicts;
+  shard.last.Add(last);
+  shard.total.Add(total);
+}
+
+void TxnStats::Report(const string &phase, double seconds) {
+  Shard sum;
+  for (Shard &shard : shards_) {
+    sum.txns += shard.txns;
+    sum.commits += shard.commits;
+    sum.attempts += shard.attempts;
+    sum.conflicts += shard.conflicts;
+    sum.last.Merge(shard.last);
+    sum.total.Merge(shard.total);
+    shard = Shard();
+  }
+  if (!sum.txns) return;
+
+  std::cout << "# " << phase << " transactions" << endl;
+  std::cout << "txns\tcommits\tcommits/s\tattempts\taborts\tabort rate"
+            << endl;
+  std::cout << sum.txns << '\t' << sum.commits << '\t'
+            << (seconds > 0 ? sum.commits / seconds : 0) << '\t'
+            << sum.attempts << '\t' << sum.conflicts << '\t'
+            << double(sum.conflicts) / sum.attempts << endl;
+  std::cout << "# " << phase << " transaction latency (us)" << endl;
+  std::cout << "\tcount\tmean\tp50\tp99\tp99.9\tmax" << endl;
+  utils::PrintLatencyRow(std::cout, "all attempts", sum.total);
+  utils::PrintLatencyRow(std::cout, "last attempt", sum.last);
+}
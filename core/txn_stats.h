@@ -0,0 +1,55 @@
+//
+//  txn_stats.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_TXN_STATS_H_
+#define YCSB_C_TXN_STATS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "histogram.h"
+
+namespace ycsbc {
+
+///
+/// Counts, per shard, the multi-key transactions of a phase and how often
+/// they aborted on conflicts, with their latency both over all attempts and
+/// of the last attempt alone, which leaves out the work lost to retries.
+///
+class TxnStats {
+ public:
+  TxnStats();
+
+  ///
+  /// Records a transaction of the calling shard that ended with status
+  /// after attempts tries, conflicts of which aborted on a conflict, the
+  /// last taking last seconds of the total.
+  ///
+  void Add(int attempts, int conflicts, int status, double last,
+           double total);
+  ///
+  /// Prints the transactions of the phase, which took seconds, then forgets
+  /// them. Prints nothing if there were none. Call when no operations are
+  /// running.
+  ///
+  void Report(const std::string &phase, double seconds);
+
+ private:
+  struct alignas(64) Shard {
+    uint64_t txns = 0;
+    uint64_t commits = 0;
+    uint64_t attempts = 0;
+    uint64_t conflicts = 0;  ///< Attempts aborted on a conflict
+    utils::Histogram last;
+    utils::Histogram total;
+  };
+
+  std::vector<Shard> shards_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_TXN_STATS_H_
@@ -33,10 +33,14 @@ class UniformGenerator : public Generator<uint64_t> {
 };
 
 inline uint64_t UniformGenerator::Next() {
+  std::lock_guard<std::mutex> lock(mutex_);
   return last_int_ = dist_(generator_);
 }
 
-inline uint64_t UniformGenerator::Last() { return last_int_; }
+inline uint64_t UniformGenerator::Last() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return last_int_;
+}
 
 }  // namespace ycsbc
 
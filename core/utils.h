@@ -56,6 +56,14 @@ class Exception : public std::exception {
   std::string message_;
 };
 
+///
+/// Splits total into n near-equal parts and returns the i-th; the parts
+/// add up to total.
+///
+inline int ShareOf(int total, int n, int i) {
+  return total / n + (i < total % n);
+}
+
 inline bool StrToBool(std::string str) {
   std::transform(str.begin(), str.end(), str.begin(), ::tolower);
   if (str == "true" || str == "1") {
@@ -0,0 +1,26 @@
+//
+//  btree_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_BTREE_DB_H_
+#define YCSB_C_BTREE_DB_H_
+
+#include "db/hashtable_db.h"
+
+#include "lib/lock_btree_table.h"
+
+namespace ycsbc {
+
+///
+/// Ordered reference engine: Scan() returns the len records whose keys
+/// follow the start key, so workload E measures real range scans.
+///
+class BTreeDB : public HashtableDB {
+ public:
+  BTreeDB() : HashtableDB(new vmp::LockBTreeTable<Record *>) { }
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_BTREE_DB_H_
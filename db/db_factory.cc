@@ -0,0 +1,37 @@
+//
+//  db_factory.cc
+//  YCSB-C
+//
+
+#include "db/db_factory.h"
+
+#include <string>
+#include "db/btree_db.h"
+#include "db/lock_stl_db.h"
+#include "db/log_db.h"
+#include "db/null_db.h"
+#include "db/resp_db.h"
+#include "db/striped_db.h"
+
+using namespace std;
+using ycsbc::DB;
+using ycsbc::DBFactory;
+
+DB *DBFactory::CreateDB(const utils::Properties &props) {
+  const string db_name = props.GetProperty("dbname");
+  if (db_name == "lock_stl") {
+    return new LockStlDB;
+  } else if (db_name == "striped") {
+    return new StripedDB;
+  } else if (db_name == "btree") {
+    return new BTreeDB;
+  } else if (db_name == "log") {
+    return new LogDB(props);
+  } else if (db_name == "null") {
+    return new NullDB;
+  } else if (db_name == "resp") {
+    return new RespDB(props);
+  } else {
+    return NULL;
+  }
+}
@@ -0,0 +1,25 @@
+//
+//  db_factory.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_DB_FACTORY_H_
+#define YCSB_C_DB_FACTORY_H_
+
+#include "core/db.h"
+#include "core/properties.h"
+
+namespace ycsbc {
+
+class DBFactory {
+ public:
+  ///
+  /// Creates the DB named by the "dbname" property.
+  /// Returns NULL if the name is unknown.
+  ///
+  static DB *CreateDB(const utils::Properties &props);
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_DB_FACTORY_H_
@@ -0,0 +1,182 @@
+//
+//  forwarding_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_FORWARDING_DB_H_
+#define YCSB_C_FORWARDING_DB_H_
+
+#include "core/db.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <seastar/core/smp.hh>
+#include <seastar/core/thread.hh>
+
+namespace ycsbc {
+
+///
+/// Runs every operation of another DB on one of a set of engine shards, so
+/// that the shards the clients run on only generate load. A key always goes
+/// to the same engine shard; a multi-read or scan goes where its first key
+/// does. Arguments and results stay in the client's memory and are only
+/// referred to from the engine shard, which the client waits for.
+/// A transaction runs whole on the engine shard of its first key, where
+/// the engine's own transaction is begun, used and committed.
+///
+class ForwardingDB : public DB {
+ public:
+  ForwardingDB(DB *db, std::vector<unsigned> shards)
+      : db_(db), shards_(std::move(shards)) {}
+
+  ///
+  /// Initializes the engine's state on every engine shard for this client.
+  ///
+  void Init() {
+    for (unsigned shard : shards_) {
+      seastar::smp::submit_to(shard, [this] {
+        return seastar::async([this] { db_->Init(); });
+      }).get();
+    }
+  }
+
+  void Close() {
+    for (unsigned shard : shards_) {
+      seastar::smp::submit_to(shard, [this] {
+        return seastar::async([this] { db_->Close(); });
+      }).get();
+    }
+  }
+
+  seastar::future<int> Read(const std::string &table, const std::string &key,
+                            const std::vector<std::string> *fields,
+                            std::vector<KVPair> &result) {
+    return seastar::smp::submit_to(ShardOf(key), [&, this] {
+      return db_->Read(table, key, fields, result);
+    });
+  }
+
+  seastar::future<int> MultiRead(const std::string &table,
+                                 const std::vector<std::string> &keys,
+                                 const std::vector<std::string> *fields,
+                                 std::vector<std::vector<KVPair>> &result) {
+    if (keys.empty()) return db_->MultiRead(table, keys, fields, result);
+    return seastar::smp::submit_to(ShardOf(keys.front()), [&, this] {
+      return db_->MultiRead(table, keys, fields, result);
+    });
+  }
+
+  seastar::future<int> Scan(const std::string &table, const std::string &key,
+                            int len, const std::vector<std::string> *fields,
+                            std::vector<std::vector<KVPair>> &result) {
+    return seastar::smp::submit_to(ShardOf(key), [&, this, len] {
+      return db_->Scan(table, key, len, fields, result);
+    });
+  }
+
+  seastar::future<int> Update(const std::string &table, const std::string &key,
+                              std::vector<KVPair> &values) {
+    return seastar::smp::submit_to(ShardOf(key), [&, this] {
+      return db_->Update(table, key, values);
+    });
+  }
+
+  seastar::future<int> Insert(const std::string &table, const std::string &key,
+                              std::vector<KVPair> &values) {
+    return seastar::smp::submit_to(ShardOf(key), [&, this] {
+      return db_->Insert(table, key, values);
+    });
+  }
+
+  seastar::future<int> Delete(const std::string &table,
+                              const std::string &key) {
+    return seastar::smp::submit_to(ShardOf(key), [&, this] {
+      return db_->Delete(table, key);
+    });
+  }
+
+  std::unique_ptr<Transaction> Begin() {
+    return std::unique_ptr<Transaction>(new ForwardedTxn);
+  }
+
+  seastar::future<int> TxnRead(Transaction *txn, const std::string &table,
+                               const std::string &key,
+                               const std::vector<std::string> *fields,
+                               std::vector<KVPair> &result) {
+    if (!txn) return Read(table, key, fields, result);
+    ForwardedTxn &t = static_cast<ForwardedTxn &>(*txn);
+    return Join(t, key).then([&, this] {
+      return seastar::smp::submit_to(t.shard, [&, this] {
+        return db_->TxnRead(t.txn.get(), table, key, fields, result);
+      });
+    });
+  }
+
+  seastar::future<int> TxnUpdate(Transaction *txn, const std::string &table,
+                                 const std::string &key,
+                                 std::vector<KVPair> &values) {
+    if (!txn) return Update(table, key, values);
+    ForwardedTxn &t = static_cast<ForwardedTxn &>(*txn);
+    return Join(t, key).then([&, this] {
+      return seastar::smp::submit_to(t.shard, [&, this] {
+        return db_->TxnUpdate(t.txn.get(), table, key, values);
+      });
+    });
+  }
+
+  seastar::future<int> Commit(std::unique_ptr<Transaction> txn) {
+    ForwardedTxn *t = static_cast<ForwardedTxn *>(txn.get());
+    // Nothing begun, or an engine without transactions
+    if (!t || !t->txn) return seastar::make_ready_future<int>(kOK);
+    return seastar::smp::submit_to(t->shard, [this, inner = t->txn.release()] {
+      return db_->Commit(std::unique_ptr<Transaction>(inner));
+    });
+  }
+
+ private:
+  ///
+  /// A transaction of the engine on shard, begun there with the first
+  /// operation and destroyed there, so that it is only touched by the shard
+  /// it belongs to.
+  ///
+  class ForwardedTxn : public Transaction {
+   public:
+    ~ForwardedTxn() {
+      if (txn) {
+        (void)seastar::smp::submit_to(shard, [t = txn.release()] {
+          delete t;
+        });
+      }
+    }
+
+    bool begun = false;
+    unsigned shard = 0;
+    std::unique_ptr<Transaction> txn;  ///< Null if the engine has none
+  };
+
+  seastar::future<> Join(ForwardedTxn &t, const std::string &key) {
+    if (t.begun) return seastar::make_ready_future<>();
+    t.begun = true;
+    t.shard = ShardOf(key);
+    return seastar::smp::submit_to(t.shard, [this] {
+      return db_->Begin();
+    }).then([&t](std::unique_ptr<Transaction> txn) {
+      t.txn = std::move(txn);
+    });
+  }
+
+  unsigned ShardOf(const std::string &key) const {
+    return shards_[std::hash<std::string>()(key) % shards_.size()];
+  }
+
+  DB *db_;
+  const std::vector<unsigned> shards_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_FORWARDING_DB_H_
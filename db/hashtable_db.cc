@@ -0,0 +1,259 @@
+//
+//  hashtable_db.cc
+//  YCSB-C
+//
+
+#include "db/hashtable_db.h"
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+#include "lib/epoch.h"
+
+using std::string;
+using std::vector;
+using vmp::EpochGuard;
+using vmp::EpochManager;
+
+namespace ycsbc {
+
+HashtableDB::~HashtableDB() {
+  for (auto &entry : key_table_->Entries()) {
+    delete entry.second;
+  }
+  delete key_table_;
+}
+
+size_t HashtableDB::RecordLockIndex(const char *key) {
+  return std::hash<std::string_view>()(key) % kNumRecordLocks;
+}
+
+class HashtableDB::Txn : public DB::Transaction {
+ public:
+  struct Seen {
+    string key;
+    uint64_t version;  ///< Of the key's stripe, before the key was read
+    bool exists;
+  };
+
+  std::vector<Seen> seen;
+  std::vector<std::pair<string, vector<KVPair>>> updates;
+
+  const Seen *Find(const string &key) const {
+    for (const Seen &s : seen) {
+      if (s.key == key) return &s;
+    }
+    return nullptr;
+  }
+  vector<KVPair> *Updates(const string &key) {
+    for (auto &u : updates) {
+      if (u.first == key) return &u.second;
+    }
+    return nullptr;
+  }
+};
+
+void HashtableDB::CopyFields(const Record &record,
+                             const vector<string> *fields,
+                             vector<KVPair> &result) {
+  if (!fields) {
+    result.insert(result.end(), record.begin(), record.end());
+    return;
+  }
+  for (const string &field : *fields) {
+    for (const KVPair &pair : record) {
+      if (pair.first == field) {
+        result.push_back(pair);
+        break;
+      }
+    }
+  }
+}
+
+void HashtableDB::SetFields(Record &record, const vector<KVPair> &values) {
+  for (const KVPair &value : values) {
+    auto it = record.begin();
+    while (it != record.end() && it->first != value.first) ++it;
+    if (it == record.end()) {
+      record.push_back(value);
+    } else {
+      it->second = value.second;
+    }
+  }
+}
+
+int HashtableDB::ReadRecord(const char *key, const vector<string> *fields,
+                            vector<KVPair> &result) {
+  EpochGuard guard;
+  Record *record = key_table_->Get(key);
+  if (!record) return kErrorNoData;
+  CopyFields(*record, fields, result);
+  return kOK;
+}
+
+seastar::future<int> HashtableDB::Read(const string &table, const string &key,
+                                       const vector<string> *fields,
+                                       vector<KVPair> &result) {
+  return seastar::make_ready_future<int>(
+      ReadRecord(key.c_str(), fields, result));
+}
+
+seastar::future<int> HashtableDB::MultiRead(const string &table,
+                                            const vector<string> &keys,
+                                            const vector<string> *fields,
+                                            vector<vector<KVPair>> &result) {
+  int status = kOK;
+  result.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (ReadRecord(keys[i].c_str(), fields, result[i]) != kOK) {
+      status = kErrorNoData;
+    }
+  }
+  return seastar::make_ready_future<int>(status);
+}
+
+seastar::future<int> HashtableDB::Scan(const string &table, const string &key,
+                                       int len, const vector<string> *fields,
+                                       vector<vector<KVPair>> &result) {
+  // Keys and records returned by Entries() are not freed before the guard
+  // is left, even if they are concurrently replaced or removed.
+  EpochGuard guard;
+  vector<KeyHashtable::KVPair> entries = key_table_->Entries(key.c_str(), len);
+  result.resize(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    CopyFields(*entries[i].second, fields, result[i]);
+  }
+  return seastar::make_ready_future<int>(kOK);
+}
+
+seastar::future<int> HashtableDB::Update(const string &table,
+                                         const string &key,
+                                         vector<KVPair> &values) {
+  std::lock_guard<std::mutex> lock(RecordLock(key.c_str()));
+  Record *old = key_table_->Get(key.c_str());
+  if (!old) return seastar::make_ready_future<int>(kErrorNoData);
+  Record *record = new Record(*old);
+  SetFields(*record, values);
+  EpochManager::Global().RetireObject(key_table_->Update(key.c_str(), record));
+  RecordVersion(key.c_str()).fetch_add(1, std::memory_order_release);
+  return seastar::make_ready_future<int>(kOK);
+}
+
+seastar::future<int> HashtableDB::Insert(const string &table,
+                                         const string &key,
+                                         vector<KVPair> &values) {
+  std::lock_guard<std::mutex> lock(RecordLock(key.c_str()));
+  Record *record = new Record(values);
+  if (!key_table_->Insert(key.c_str(), record)) {
+    delete record;
+    return seastar::make_ready_future<int>(kErrorConflict);
+  }
+  RecordVersion(key.c_str()).fetch_add(1, std::memory_order_release);
+  return seastar::make_ready_future<int>(kOK);
+}
+
+seastar::future<int> HashtableDB::Delete(const string &table,
+                                         const string &key) {
+  std::lock_guard<std::mutex> lock(RecordLock(key.c_str()));
+  Record *record = key_table_->Remove(key.c_str());
+  if (!record) return seastar::make_ready_future<int>(kErrorNoData);
+  EpochManager::Global().RetireObject(record);
+  RecordVersion(key.c_str()).fetch_add(1, std::memory_order_release);
+  return seastar::make_ready_future<int>(kOK);
+}
+
+bool HashtableDB::See(Txn &txn, const string &key) {
+  if (const Txn::Seen *seen = txn.Find(key)) return seen->exists;
+  // The version is read first: a write it misses changes it, so the
+  // transaction can only abort for having seen a newer record.
+  const uint64_t version =
+      RecordVersion(key.c_str()).load(std::memory_order_acquire);
+  EpochGuard guard;
+  const bool exists = key_table_->Get(key.c_str()) != nullptr;
+  txn.seen.push_back({key, version, exists});
+  return exists;
+}
+
+std::unique_ptr<DB::Transaction> HashtableDB::Begin() {
+  return std::unique_ptr<Transaction>(new Txn);
+}
+
+seastar::future<int> HashtableDB::TxnRead(Transaction *txn,
+                                          const string &table,
+                                          const string &key,
+                                          const vector<string> *fields,
+                                          vector<KVPair> &result) {
+  if (!txn) return Read(table, key, fields, result);
+  Txn &t = static_cast<Txn &>(*txn);
+  if (!See(t, key)) return seastar::make_ready_future<int>(kErrorNoData);
+  EpochGuard guard;
+  // A newer record than the one first seen fails the commit
+  const Record *current = key_table_->Get(key.c_str());
+  if (!current) return seastar::make_ready_future<int>(kErrorConflict);
+  const vector<KVPair> *updates = t.Updates(key);
+  if (!updates) {
+    CopyFields(*current, fields, result);
+  } else {
+    Record record(*current);
+    SetFields(record, *updates);
+    CopyFields(record, fields, result);
+  }
+  return seastar::make_ready_future<int>(kOK);
+}
+
+seastar::future<int> HashtableDB::TxnUpdate(Transaction *txn,
+                                            const string &table,
+                                            const string &key,
+                                            vector<KVPair> &values) {
+  if (!txn) return Update(table, key, values);
+  Txn &t = static_cast<Txn &>(*txn);
+  if (!See(t, key)) return seastar::make_ready_future<int>(kErrorNoData);
+  vector<KVPair> *updates = t.Updates(key);
+  if (!updates) {
+    t.updates.emplace_back(key, values);
+  } else {
+    SetFields(*updates, values);
+  }
+  return seastar::make_ready_future<int>(kOK);
+}
+
+seastar::future<int> HashtableDB::Commit(std::unique_ptr<Transaction> txn) {
+  if (!txn) return seastar::make_ready_future<int>(kOK);
+  Txn &t = static_cast<Txn &>(*txn);
+  // Stripes are taken in index order, so committers cannot deadlock
+  vector<size_t> stripes;
+  for (auto &s : t.seen) stripes.push_back(RecordLockIndex(s.key.c_str()));
+  std::sort(stripes.begin(), stripes.end());
+  stripes.erase(std::unique(stripes.begin(), stripes.end()), stripes.end());
+  for (size_t i : stripes) record_locks_[i].lock();
+
+  int status = kOK;
+  for (auto &s : t.seen) {
+    if (RecordVersion(s.key.c_str()).load(std::memory_order_relaxed) !=
+        s.version) {
+      status = kErrorConflict;
+      break;
+    }
+  }
+  if (status == kOK) {
+    // Each updated key was seen to exist, and no stripe has changed since
+    EpochGuard guard;
+    for (auto &u : t.updates) {
+      Record *record = new Record(*key_table_->Get(u.first.c_str()));
+      SetFields(*record, u.second);
+      EpochManager::Global().RetireObject(
+          key_table_->Update(u.first.c_str(), record));
+    }
+    for (size_t i : stripes) {
+      record_versions_[i].fetch_add(1, std::memory_order_release);
+    }
+  }
+  for (auto i = stripes.rbegin(); i != stripes.rend(); ++i) {
+    record_locks_[*i].unlock();
+  }
+  return seastar::make_ready_future<int>(status);
+}
+
+}  // namespace ycsbc
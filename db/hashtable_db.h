@@ -0,0 +1,123 @@
+//
+//  hashtable_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_HASHTABLE_DB_H_
+#define YCSB_C_HASHTABLE_DB_H_
+
+#include "core/db.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "lib/string_hashtable.h"
+
+namespace ycsbc {
+
+///
+/// In-memory DB over any vmp::StringHashtable. A record is a vector of
+/// field/value pairs; Scan() walks the table's Entries(), so it is ordered
+/// only when the underlying table is.
+///
+/// Records are immutable once published: Update() installs a modified copy
+/// and retires the old one through the epoch manager, so reads only hold an
+/// EpochGuard and take no lock beyond what the table itself needs.
+///
+/// Transactions are optimistic: a transaction remembers the version of the
+/// lock stripe of each key it reads and buffers its updates; Commit() locks
+/// the stripes of all those keys, checks that none has changed version, and
+/// only then installs the updates. Every write bumps its stripe's version,
+/// so keys sharing a stripe may conflict falsely. A transaction holds no
+/// EpochGuard between calls, as it may live across waits.
+///
+class HashtableDB : public DB {
+ public:
+  typedef std::vector<KVPair> Record;
+  typedef vmp::StringHashtable<Record *> KeyHashtable;
+
+  seastar::future<int> Read(const std::string &table, const std::string &key,
+                            const std::vector<std::string> *fields,
+                            std::vector<KVPair> &result);
+
+  seastar::future<int> MultiRead(const std::string &table,
+                                 const std::vector<std::string> &keys,
+                                 const std::vector<std::string> *fields,
+                                 std::vector<std::vector<KVPair>> &result);
+
+  seastar::future<int> Scan(const std::string &table, const std::string &key,
+                            int len, const std::vector<std::string> *fields,
+                            std::vector<std::vector<KVPair>> &result);
+
+  seastar::future<int> Update(const std::string &table, const std::string &key,
+                              std::vector<KVPair> &values);
+
+  seastar::future<int> Insert(const std::string &table, const std::string &key,
+                              std::vector<KVPair> &values);
+
+  seastar::future<int> Delete(const std::string &table,
+                              const std::string &key);
+
+  std::unique_ptr<Transaction> Begin();
+
+  seastar::future<int> TxnRead(Transaction *txn, const std::string &table,
+                               const std::string &key,
+                               const std::vector<std::string> *fields,
+                               std::vector<KVPair> &result);
+
+  seastar::future<int> TxnUpdate(Transaction *txn, const std::string &table,
+                                 const std::string &key,
+                                 std::vector<KVPair> &values);
+
+  seastar::future<int> Commit(std::unique_ptr<Transaction> txn);
+
+  virtual ~HashtableDB();
+
+ protected:
+  HashtableDB(KeyHashtable *table) : key_table_(table) { }
+
+  KeyHashtable *key_table_;
+
+ private:
+  ///
+  /// Writers of one key are serialized by a lock stripe chosen by the key,
+  /// so that concurrent read-copy-updates do not lose fields.
+  ///
+  static const size_t kNumRecordLocks = 1024;
+  static size_t RecordLockIndex(const char *key);
+  std::mutex &RecordLock(const char *key) {
+    return record_locks_[RecordLockIndex(key)];
+  }
+  ///
+  /// Counts the writes under a stripe: bumped, with its lock held, after
+  /// every record of the stripe is installed or removed.
+  ///
+  std::atomic<uint64_t> &RecordVersion(const char *key) {
+    return record_versions_[RecordLockIndex(key)];
+  }
+  ///
+  /// Notes in txn, if it has not yet, the version of key's stripe and
+  /// whether key exists, and returns whether it does.
+  ///
+  class Txn;
+  bool See(Txn &txn, const std::string &key);
+
+  static void CopyFields(const Record &record,
+                         const std::vector<std::string> *fields,
+                         std::vector<KVPair> &result);
+  ///
+  /// Sets the fields of values in record, adding those it lacks.
+  ///
+  static void SetFields(Record &record, const std::vector<KVPair> &values);
+  int ReadRecord(const char *key, const std::vector<std::string> *fields,
+                 std::vector<KVPair> &result);
+
+  std::mutex record_locks_[kNumRecordLocks];
+  std::atomic<uint64_t> record_versions_[kNumRecordLocks] = {};
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_HASHTABLE_DB_H_
@@ -0,0 +1,22 @@
+//
+//  lock_stl_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_LOCK_STL_DB_H_
+#define YCSB_C_LOCK_STL_DB_H_
+
+#include "db/hashtable_db.h"
+
+#include "lib/lock_stl_hashtable.h"
+
+namespace ycsbc {
+
+class LockStlDB : public HashtableDB {
+ public:
+  LockStlDB() : HashtableDB(new vmp::LockStlHashtable<Record *>) { }
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_LOCK_STL_DB_H_
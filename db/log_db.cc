@@ -0,0 +1,759 @@
+//
+//  log_db.cc
+//  YCSB-C
+//
+
+#include "db/log_db.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string_view>
+
+#include "core/utils.h"
+#include "lib/epoch.h"
+
+#include <boost/range/irange.hpp>
+#include <seastar/core/align.hh>
+#include <seastar/core/do_with.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/smp.hh>
+
+using std::string;
+using std::vector;
+using vmp::EpochGuard;
+using vmp::EpochManager;
+
+namespace ycsbc {
+
+const string LogDB::DIR_PROPERTY = "logdb.dir";
+const string LogDB::DIR_DEFAULT = "logdb";
+
+const string LogDB::SEGMENT_SIZE_PROPERTY = "logdb.segment_size";
+const string LogDB::SEGMENT_SIZE_DEFAULT = "67108864";
+
+const string LogDB::BUFFER_SIZE_PROPERTY = "logdb.buffer_size";
+const string LogDB::BUFFER_SIZE_DEFAULT = "65536";
+
+const string LogDB::FLUSH_PROPERTY = "logdb.flush";
+const string LogDB::FLUSH_DEFAULT = "always";
+
+const string LogDB::FSYNC_PROPERTY = "logdb.fsync";
+const string LogDB::FSYNC_DEFAULT = "never";
+const string LogDB::FSYNC_INTERVAL_PROPERTY = "logdb.fsync_interval_ms";
+const string LogDB::FSYNC_INTERVAL_DEFAULT = "100";
+
+const string LogDB::COMPACT_RATIO_PROPERTY = "logdb.compact_ratio";
+const string LogDB::COMPACT_RATIO_DEFAULT = "0.5";
+const string LogDB::COMPACT_INTERVAL_PROPERTY = "logdb.compact_interval_ms";
+const string LogDB::COMPACT_INTERVAL_DEFAULT = "1000";
+
+namespace {
+
+///
+/// An entry is a header, the key and, unless it is a tombstone, the fields
+/// as length-prefixed name/value pairs. Entries are packed back to back;
+/// only the end of a segment is padded to a block.
+///
+struct EntryHeader {
+  uint32_t magic;
+  uint32_t flags;
+  uint32_t key_size;
+  uint32_t value_size;
+};
+
+const uint32_t kEntryMagic = 0x59434C47;  // "YCLG"
+const uint32_t kTombstone = 1;
+
+const std::size_t kCompactionChunk = 1 << 20;
+
+void AppendString(string &out, const string &s) {
+  uint32_t size = s.size();
+  out.append(reinterpret_cast<const char *>(&size), sizeof(size));
+  out.append(s);
+}
+
+string ReadString(const char *&p) {
+  uint32_t size;
+  memcpy(&size, p, sizeof(size));
+  p += sizeof(size);
+  string s(p, size);
+  p += size;
+  return s;
+}
+
+string EncodeEntry(const string &key, const vector<DB::KVPair> *record) {
+  string value;
+  if (record) {
+    for (const DB::KVPair &pair : *record) {
+      AppendString(value, pair.first);
+      AppendString(value, pair.second);
+    }
+  }
+  EntryHeader header = {kEntryMagic, record ? 0 : kTombstone,
+                        uint32_t(key.size()), uint32_t(value.size())};
+  string entry;
+  entry.reserve(sizeof(header) + key.size() + value.size());
+  entry.append(reinterpret_cast<const char *>(&header), sizeof(header));
+  entry.append(key);
+  entry.append(value);
+  return entry;
+}
+
+vector<DB::KVPair> DecodeEntry(const char *entry) {
+  EntryHeader header;
+  memcpy(&header, entry, sizeof(header));
+  if (header.magic != kEntryMagic) {
+    throw utils::Exception("LogDB: corrupt log entry");
+  }
+  const char *p = entry + sizeof(header) + header.key_size;
+  const char *end = p + header.value_size;
+  vector<DB::KVPair> record;
+  while (p < end) {
+    string field = ReadString(p);
+    record.emplace_back(std::move(field), ReadString(p));
+  }
+  return record;
+}
+
+void CopyFields(const vector<DB::KVPair> &record,
+                const vector<string> *fields, vector<DB::KVPair> &result) {
+  if (!fields) {
+    result.insert(result.end(), record.begin(), record.end());
+    return;
+  }
+  for (const string &field : *fields) {
+    for (const DB::KVPair &pair : record) {
+      if (pair.first == field) {
+        result.push_back(pair);
+        break;
+      }
+    }
+  }
+}
+
+///
+/// Background work has no caller to return its error to.
+///
+void LogError(const char *what, std::exception_ptr e) {
+  try {
+    std::rethrow_exception(e);
+  } catch (const std::exception &ex) {
+    std::cerr << "LogDB: " << what << ": " << ex.what() << std::endl;
+  }
+}
+
+}  // namespace
+
+LogDB::LogDB(const utils::Properties &props)
+    : dir_(props.GetProperty(DIR_PROPERTY, DIR_DEFAULT)),
+      segment_size_(std::stoull(
+          props.GetProperty(SEGMENT_SIZE_PROPERTY, SEGMENT_SIZE_DEFAULT))),
+      buffer_size_(std::stoull(
+          props.GetProperty(BUFFER_SIZE_PROPERTY, BUFFER_SIZE_DEFAULT))),
+      sync_interval_ms_(std::stoul(
+          props.GetProperty(FSYNC_INTERVAL_PROPERTY, FSYNC_INTERVAL_DEFAULT))),
+      compact_ratio_(std::stod(
+          props.GetProperty(COMPACT_RATIO_PROPERTY, COMPACT_RATIO_DEFAULT))),
+      compact_interval_ms_(std::stoul(props.GetProperty(
+          COMPACT_INTERVAL_PROPERTY, COMPACT_INTERVAL_DEFAULT))),
+      shards_(seastar::smp::count),
+      active_clients_(0) {
+  const string flush = props.GetProperty(FLUSH_PROPERTY, FLUSH_DEFAULT);
+  if (flush == "always") {
+    flush_ = kFlushAlways;
+  } else if (flush == "full") {
+    flush_ = kFlushFull;
+  } else {
+    throw utils::Exception("Unknown LogDB flush policy: " + flush);
+  }
+
+  const string fsync = props.GetProperty(FSYNC_PROPERTY, FSYNC_DEFAULT);
+  if (fsync == "never") {
+    sync_ = kSyncNever;
+  } else if (fsync == "always") {
+    sync_ = kSyncAlways;
+    flush_ = kFlushAlways;
+  } else if (fsync == "interval") {
+    sync_ = kSyncInterval;
+  } else {
+    throw utils::Exception("Unknown LogDB fsync policy: " + fsync);
+  }
+}
+
+LogDB::~LogDB() {
+  seastar::smp::invoke_on_all([this] {
+    if (!shards_[seastar::this_shard_id()]) {
+      return seastar::make_ready_future<>();
+    }
+    return StopShard(local_shard()).then([this] {
+      shards_[seastar::this_shard_id()].reset();
+    });
+  }).get();
+  for (auto &entry : index_.Entries()) {
+    delete entry.second;
+  }
+}
+
+void LogDB::Init() {
+  std::unique_ptr<Shard> &shard = shards_[seastar::this_shard_id()];
+  if (!shard) {
+    shard = std::make_unique<Shard>();
+    shard->opened = seastar::shared_future<>(OpenShard(*shard));
+  }
+  ++shard->clients;
+  ++active_clients_;
+  shard->opened->get_future().get();
+}
+
+void LogDB::Close() {
+  Shard &shard = local_shard();
+  if (--shard.clients == 0) Sync(shard, sync_ != kSyncNever).get();
+  if (active_clients_.fetch_sub(1) == 1) PrintStats();
+}
+
+std::mutex &LogDB::RecordLock(const char *key) {
+  size_t h = std::hash<std::string_view>()(key);
+  return record_locks_[h % kNumRecordLocks];
+}
+
+seastar::future<> LogDB::OpenShard(Shard &shard) {
+  return seastar::recursive_touch_directory(dir_).then([this, &shard] {
+    return OpenSegment(shard);
+  }).then([this, &shard] {
+    shard.compact_timer.set_callback([this, &shard] { MaybeCompact(shard); });
+    shard.compact_timer.arm_periodic(
+        std::chrono::milliseconds(compact_interval_ms_));
+    if (sync_ == kSyncInterval) {
+      shard.sync_timer.set_callback([this, &shard] {
+        if (shard.background.is_closed()) return;
+        (void)seastar::with_gate(shard.background, [this, &shard] {
+          return Sync(shard, true);
+        }).handle_exception([](std::exception_ptr e) {
+          LogError("fsync failed", e);
+        });
+      });
+      shard.sync_timer.arm_periodic(
+          std::chrono::milliseconds(sync_interval_ms_));
+    }
+  });
+}
+
+seastar::future<> LogDB::StopShard(Shard &shard) {
+  shard.compact_timer.cancel();
+  shard.sync_timer.cancel();
+  return shard.background.close().then([this, &shard] {
+    return Sync(shard, sync_ != kSyncNever);
+  }).then([&shard] {
+    return seastar::parallel_for_each(shard.segments, [](auto &entry) {
+      seastar::lw_shared_ptr<Segment> segment = entry.second;
+      return segment->reads.close().then([segment] {
+        return segment->file.close();
+      });
+    });
+  });
+}
+
+seastar::future<> LogDB::OpenSegment(Shard &shard) {
+  uint32_t id = shard.next_segment++;
+  string path = dir_ + "/shard" + std::to_string(seastar::this_shard_id()) +
+                "-" + std::to_string(id) + ".log";
+  auto flags = seastar::open_flags::rw | seastar::open_flags::create |
+               seastar::open_flags::truncate;
+  return seastar::open_file_dma(path, flags).then(
+      [this, &shard, id, path](seastar::file file) {
+    auto segment = seastar::make_lw_shared<Segment>();
+    segment->id = id;
+    segment->path = path;
+    segment->file = std::move(file);
+    if (shard.buffer.empty()) {
+      shard.alignment = segment->file.disk_write_dma_alignment();
+      shard.buffer = seastar::temporary_buffer<char>::aligned(
+          shard.alignment, seastar::align_up(buffer_size_, shard.alignment));
+    }
+    shard.segments[id] = segment;
+    shard.active = segment;
+    shard.buffer_pos = 0;
+    shard.buffer_len = 0;
+    shard.dirty = false;
+  });
+}
+
+seastar::future<> LogDB::SealSegment(Shard &shard) {
+  return Flush(shard).then([this, &shard] {
+    return sync_ != kSyncNever ? Fsync(shard) : seastar::make_ready_future<>();
+  });
+}
+
+seastar::future<LogDB::Location> LogDB::Append(Shard &shard, string entry,
+                                               bool durable) {
+  return seastar::with_semaphore(shard.write_lock, 1,
+      [this, &shard, entry = std::move(entry), durable]() mutable {
+    seastar::future<> ready = seastar::make_ready_future<>();
+    if (shard.active->size > 0 &&
+        shard.active->size + entry.size() > segment_size_) {
+      ready = SealSegment(shard).then([this, &shard] {
+        return OpenSegment(shard);
+      }).then([this, &shard] { MaybeCompact(shard); });
+    }
+    return ready.then([this, &shard, entry = std::move(entry)]() mutable {
+      if (shard.buffer_len + entry.size() <= shard.buffer.size()) {
+        return seastar::make_ready_future<string>(std::move(entry));
+      }
+      // Leaves at most one partial block in the buffer.
+      return Flush(shard).then([entry = std::move(entry)]() mutable {
+        return std::move(entry);
+      });
+    }).then([this, &shard, durable](string entry) {
+      if (shard.buffer_len + entry.size() > shard.buffer.size()) {
+        auto buffer = seastar::temporary_buffer<char>::aligned(
+            shard.alignment,
+            seastar::align_up(shard.buffer_len + entry.size(),
+                              shard.alignment));
+        memcpy(buffer.get_write(), shard.buffer.get(), shard.buffer_len);
+        shard.buffer = std::move(buffer);
+      }
+      Location loc = {seastar::this_shard_id(), shard.active->id,
+                      shard.buffer_pos + shard.buffer_len,
+                      uint32_t(entry.size())};
+      memcpy(shard.buffer.get_write() + shard.buffer_len, entry.data(),
+             entry.size());
+      shard.buffer_len += entry.size();
+      shard.dirty = true;
+      shard.active->size += entry.size();
+      shard.total_bytes += entry.size();
+      Stats::Add(shard.stats.logical_write_bytes, entry.size());
+
+      seastar::future<> done = seastar::make_ready_future<>();
+      if (durable && flush_ == kFlushAlways) done = Flush(shard);
+      if (durable && sync_ == kSyncAlways) {
+        done = done.then([this, &shard] { return Fsync(shard); });
+      }
+      return done.then([loc] { return loc; });
+    });
+  });
+}
+
+seastar::future<> LogDB::Flush(Shard &shard) {
+  if (!shard.dirty) return seastar::make_ready_future<>();
+  std::size_t len = seastar::align_up(shard.buffer_len, shard.alignment);
+  memset(shard.buffer.get_write() + shard.buffer_len, 0,
+         len - shard.buffer_len);
+  Stats::Add(shard.stats.disk_write_bytes, len);
+  seastar::lw_shared_ptr<Segment> segment = shard.active;
+  return segment->file.dma_write(shard.buffer_pos, shard.buffer.get(), len)
+      .then([&shard, segment, len](size_t written) {
+    if (written != len) {
+      throw utils::Exception("LogDB: short write to " + segment->path);
+    }
+    // Whole blocks are done with; a partial one is rewritten next time.
+    std::size_t full = seastar::align_down(shard.buffer_len, shard.alignment);
+    memmove(shard.buffer.get_write(), shard.buffer.get() + full,
+            shard.buffer_len - full);
+    shard.buffer_pos += full;
+    shard.buffer_len -= full;
+    shard.dirty = false;
+  });
+}
+
+seastar::future<> LogDB::Fsync(Shard &shard) {
+  Stats::Add(shard.stats.fsyncs, 1);
+  return shard.active->file.flush();
+}
+
+seastar::future<> LogDB::Sync(Shard &shard, bool fsync) {
+  return seastar::with_semaphore(shard.write_lock, 1, [this, &shard, fsync] {
+    return Flush(shard).then([this, &shard, fsync] {
+      return fsync ? Fsync(shard) : seastar::make_ready_future<>();
+    });
+  });
+}
+
+seastar::future<LogDB::MaybeRecord> LogDB::ReadAt(const Location &loc) {
+  if (loc.shard == seastar::this_shard_id()) return ReadLocal(loc);
+  return seastar::smp::submit_to(loc.shard, [this, loc] {
+    return ReadLocal(loc);
+  });
+}
+
+seastar::future<LogDB::MaybeRecord> LogDB::ReadLocal(const Location &loc) {
+  Shard &shard = local_shard();
+  auto it = shard.segments.find(loc.segment);
+  if (it == shard.segments.end()) {
+    return seastar::make_ready_future<MaybeRecord>();
+  }
+  seastar::lw_shared_ptr<Segment> segment = it->second;
+  Stats::Add(shard.stats.logical_read_bytes, loc.size);
+  if (segment == shard.active && loc.offset >= shard.buffer_pos) {
+    return seastar::make_ready_future<MaybeRecord>(
+        DecodeEntry(shard.buffer.get() + (loc.offset - shard.buffer_pos)));
+  }
+
+  Stats::Add(shard.stats.disk_read_bytes,
+             seastar::align_up(loc.offset + loc.size, shard.alignment) -
+                 seastar::align_down(loc.offset, shard.alignment));
+  return seastar::with_gate(segment->reads, [segment, loc] {
+    return segment->file.dma_read<char>(loc.offset, loc.size).then(
+        [segment, loc](seastar::temporary_buffer<char> buf) -> MaybeRecord {
+      if (buf.size() != loc.size) {
+        throw utils::Exception("LogDB: short read from " + segment->path);
+      }
+      return DecodeEntry(buf.get());
+    });
+  });
+}
+
+seastar::future<LogDB::MaybeRecord> LogDB::Fetch(const string &key) {
+  return seastar::repeat_until_value(
+      [this, &key]() -> seastar::future<std::optional<MaybeRecord>> {
+    Location loc;
+    if (!Find(key.c_str(), &loc)) {
+      return seastar::make_ready_future<std::optional<MaybeRecord>>(
+          std::make_optional(MaybeRecord()));
+    }
+    return ReadAt(loc).then([](MaybeRecord record) {
+      // No record means it was compacted away: look it up again.
+      return record ? std::make_optional(std::move(record))
+                    : std::optional<MaybeRecord>();
+    });
+  });
+}
+
+seastar::future<> LogDB::FetchAll(const vector<string> &keys,
+                                  vector<MaybeRecord> &records) {
+  records.resize(keys.size());
+  return seastar::parallel_for_each(boost::irange<size_t>(0, keys.size()),
+      [this, &keys, &records](size_t i) {
+    return Fetch(keys[i]).then([&records, i](MaybeRecord record) {
+      records[i] = std::move(record);
+    });
+  });
+}
+
+bool LogDB::Find(const char *key, Location *loc) {
+  EpochGuard guard;
+  Location *current = index_.Get(key);
+  if (!current) return false;
+  *loc = *current;
+  return true;
+}
+
+bool LogDB::Publish(const char *key, const Location *expected,
+                    const Location &loc) {
+  std::lock_guard<std::mutex> lock(RecordLock(key));
+  // Only holders of this lock retire the key's locations.
+  Location *current = index_.Get(key);
+  if (!current != !expected) return false;
+  if (current && !(*current == *expected)) return false;
+  Location *next = new Location(loc);
+  if (!current) {
+    index_.Insert(key, next);
+    return true;
+  }
+  index_.Update(key, next);
+  MarkDead(*current);
+  EpochManager::Global().RetireObject(current);
+  return true;
+}
+
+bool LogDB::Unpublish(const char *key) {
+  std::lock_guard<std::mutex> lock(RecordLock(key));
+  Location *current = index_.Remove(key);
+  if (!current) return false;
+  MarkDead(*current);
+  EpochManager::Global().RetireObject(current);
+  return true;
+}
+
+void LogDB::MarkDead(const Location &loc) {
+  shards_[loc.shard]->dead_bytes.fetch_add(loc.size,
+                                           std::memory_order_relaxed);
+}
+
+void LogDB::MaybeCompact(Shard &shard) {
+  if (shard.compacting || shard.background.is_closed() ||
+      shard.segments.size() < 2) {
+    return;
+  }
+  uint64_t dead = shard.dead_bytes.load(std::memory_order_relaxed);
+  if (dead <= compact_ratio_ * shard.total_bytes) return;
+
+  shard.compacting = true;
+  (void)seastar::with_gate(shard.background, [this, &shard] {
+    return Compact(shard).finally([&shard] { shard.compacting = false; });
+  }).handle_exception([](std::exception_ptr e) {
+    LogError("compaction failed", e);
+  });
+}
+
+seastar::future<> LogDB::Compact(Shard &shard) {
+  // The oldest segment; the active one is always the newest.
+  seastar::lw_shared_ptr<Segment> segment = shard.segments.begin()->second;
+  return seastar::do_with(uint64_t(0), std::size_t(0),
+      [this, &shard, segment](uint64_t &pos, std::size_t &need) {
+    return seastar::do_until([segment, &pos] { return pos >= segment->size; },
+        [this, &shard, segment, &pos, &need] {
+      std::size_t len = std::min<uint64_t>(
+          std::max(kCompactionChunk, need), segment->size - pos);
+      Stats::Add(shard.stats.disk_read_bytes,
+                 seastar::align_up(pos + len, shard.alignment) -
+                     seastar::align_down(pos, shard.alignment));
+      return segment->file.dma_read<char>(pos, len).then(
+          [this, segment, &pos, &need](seastar::temporary_buffer<char> buf) {
+        vector<LiveEntry> live;
+        std::size_t off = 0;
+        need = 0;
+        while (off + sizeof(EntryHeader) <= buf.size()) {
+          EntryHeader header;
+          memcpy(&header, buf.get() + off, sizeof(header));
+          if (header.magic != kEntryMagic) {
+            throw utils::Exception("LogDB: corrupt entry in " + segment->path);
+          }
+          std::size_t size =
+              sizeof(header) + header.key_size + header.value_size;
+          if (off + size > buf.size()) {
+            need = size;
+            break;
+          }
+          Location loc = {seastar::this_shard_id(), segment->id, pos + off,
+                          uint32_t(size)};
+          string key(buf.get() + off + sizeof(header), header.key_size);
+          Location current;
+          if (!(header.flags & kTombstone) && Find(key.c_str(), &current) &&
+              current == loc) {
+            string bytes(buf.get() + off, size);
+            live.push_back({std::move(key), loc, std::move(bytes)});
+          }
+          off += size;
+        }
+        if (off == 0 && need <= buf.size()) {
+          throw utils::Exception("LogDB: truncated entry in " + segment->path);
+        }
+        pos += off;
+        return live;
+      }).then([this, &shard](vector<LiveEntry> live) {
+        return seastar::do_with(std::move(live),
+            [this, &shard](vector<LiveEntry> &live) {
+          return seastar::do_for_each(live,
+              [this, &shard](LiveEntry &entry) {
+            // Made durable once, below, not record by record
+            return Append(shard, entry.bytes, false).then(
+                [this, &entry](Location loc) {
+              // Lost to a concurrent writer, whose entry is the live one.
+              if (!Publish(entry.key.c_str(), &entry.location, loc)) {
+                MarkDead(loc);
+              }
+            });
+          });
+        });
+      });
+    }).then([this, &shard] {
+      // The moved records must be durable before their old copies go
+      return Sync(shard, sync_ != kSyncNever);
+    }).then([this, &shard, segment] {
+      shard.segments.erase(segment->id);
+      shard.total_bytes -= segment->size;
+      // Every entry left behind is dead by now: moving a live one marked
+      // its old copy dead when the move was published.
+      uint64_t dead = shard.dead_bytes.fetch_sub(segment->size,
+                                                 std::memory_order_relaxed);
+      assert(dead >= segment->size);
+      (void)dead;
+      Stats::Add(shard.stats.compactions, 1);
+      return segment->reads.close().then([segment] {
+        return segment->file.close();
+      }).then([segment] {
+        return seastar::remove_file(segment->path);
+      });
+    });
+  });
+}
+
+seastar::future<int> LogDB::Read(const string &table, const string &key,
+                                 const vector<string> *fields,
+                                 vector<KVPair> &result) {
+  Stats::Add(local_shard().stats.ops, 1);
+  return Fetch(key).then([fields, &result](MaybeRecord record) {
+    if (!record) return kErrorNoData;
+    CopyFields(*record, fields, result);
+    return kOK;
+  });
+}
+
+seastar::future<int> LogDB::MultiRead(const string &table,
+                                      const vector<string> &keys,
+                                      const vector<string> *fields,
+                                      vector<vector<KVPair>> &result) {
+  Stats::Add(local_shard().stats.ops, 1);
+  return seastar::do_with(vector<MaybeRecord>(),
+      [this, &keys, fields, &result](vector<MaybeRecord> &records) {
+    return FetchAll(keys, records).then([fields, &result, &records] {
+      int status = kOK;
+      result.resize(records.size());
+      for (size_t i = 0; i < records.size(); ++i) {
+        if (records[i]) {
+          CopyFields(*records[i], fields, result[i]);
+        } else {
+          status = kErrorNoData;
+        }
+      }
+      return status;
+    });
+  });
+}
+
+seastar::future<int> LogDB::Scan(const string &table, const string &key,
+                                 int len, const vector<string> *fields,
+                                 vector<vector<KVPair>> &result) {
+  Stats::Add(local_shard().stats.ops, 1);
+  vector<string> keys;
+  {
+    EpochGuard guard;
+    for (auto &entry : index_.Entries(key.c_str(), len)) {
+      keys.emplace_back(entry.first);
+    }
+  }
+  return seastar::do_with(std::move(keys), vector<MaybeRecord>(),
+      [this, fields, &result](vector<string> &keys,
+                              vector<MaybeRecord> &records) {
+    return FetchAll(keys, records).then([fields, &result, &records] {
+      // Records deleted since the index was walked are skipped.
+      for (MaybeRecord &record : records) {
+        if (!record) continue;
+        result.emplace_back();
+        CopyFields(*record, fields, result.back());
+      }
+      return kOK;
+    });
+  });
+}
+
+seastar::future<int> LogDB::Update(const string &table, const string &key,
+                                   vector<KVPair> &values) {
+  Stats::Add(local_shard().stats.ops, 1);
+  // Read, merge and append, then publish only if no other writer or the
+  // compactor moved the key in between; otherwise start over.
+  return seastar::repeat_until_value(
+      [this, &key, &values]() -> seastar::future<std::optional<int>> {
+    Location loc;
+    if (!Find(key.c_str(), &loc)) {
+      return seastar::make_ready_future<std::optional<int>>(kErrorNoData);
+    }
+    return ReadAt(loc).then([this, &key, &values, loc](MaybeRecord record) {
+      if (!record) return seastar::make_ready_future<std::optional<int>>();
+      for (KVPair &value : values) {
+        auto it = record->begin();
+        while (it != record->end() && it->first != value.first) ++it;
+        if (it == record->end()) {
+          record->push_back(value);
+        } else {
+          it->second = value.second;
+        }
+      }
+      return Append(local_shard(), EncodeEntry(key, &*record)).then(
+          [this, &key, loc](Location written) -> std::optional<int> {
+        if (Publish(key.c_str(), &loc, written)) return kOK;
+        MarkDead(written);
+        return std::nullopt;
+      });
+    });
+  });
+}
+
+seastar::future<int> LogDB::Insert(const string &table, const string &key,
+                                   vector<KVPair> &values) {
+  Stats::Add(local_shard().stats.ops, 1);
+  Location loc;
+  if (Find(key.c_str(), &loc)) {
+    return seastar::make_ready_future<int>(kErrorConflict);
+  }
+  return Append(local_shard(), EncodeEntry(key, &values)).then(
+      [this, &key](Location written) {
+    if (Publish(key.c_str(), NULL, written)) return kOK;
+    MarkDead(written);
+    return kErrorConflict;
+  });
+}
+
+seastar::future<int> LogDB::Delete(const string &table, const string &key) {
+  Stats::Add(local_shard().stats.ops, 1);
+  Location loc;
+  if (!Find(key.c_str(), &loc)) {
+    return seastar::make_ready_future<int>(kErrorNoData);
+  }
+  // The tombstone only costs the write a persistent engine would make.
+  return Append(local_shard(), EncodeEntry(key, NULL)).then(
+      [this, &key](Location written) {
+    MarkDead(written);
+    return Unpublish(key.c_str()) ? kOK : kErrorNoData;
+  });
+}
+
+seastar::future<int> LogDB::BulkLoad(const string &table, RecordRun &run) {
+  Shard &shard = local_shard();
+  return seastar::do_with(string(), Record(), 0,
+      [this, &shard, &run](string &key, Record &values, int &loaded) {
+    return seastar::repeat([this, &shard, &run, &key, &values, &loaded] {
+      values.clear();
+      if (!run.Next(key, values)) {
+        return seastar::make_ready_future<seastar::stop_iteration>(
+            seastar::stop_iteration::yes);
+      }
+      Stats::Add(shard.stats.ops, 1);
+      return Append(shard, EncodeEntry(key, &values), false).then(
+          [this, &key, &loaded](Location written) {
+        if (Publish(key.c_str(), NULL, written)) {
+          ++loaded;
+        } else {
+          MarkDead(written);
+        }
+        return seastar::stop_iteration::no;
+      });
+    }).then([this, &shard] {
+      return Sync(shard, sync_ != kSyncNever);
+    }).then([&loaded] { return loaded; });
+  });
+}
+
+void LogDB::PrintStats() {
+  auto sum = [this](std::atomic<uint64_t> Stats::*counter) {
+    uint64_t total = 0;
+    for (auto &shard : shards_) {
+      if (shard) total += (shard->stats.*counter).load();
+    }
+    return total;
+  };
+  double ops = std::max<uint64_t>(sum(&Stats::ops), 1);
+  double logical_write =
+      std::max<uint64_t>(sum(&Stats::logical_write_bytes), 1);
+  double logical_read = std::max<uint64_t>(sum(&Stats::logical_read_bytes), 1);
+  double disk_write = sum(&Stats::disk_write_bytes);
+  double disk_read = sum(&Stats::disk_read_bytes);
+
+  std::cout << "# LogDB I/O (bytes per operation)" << std::endl;
+  std::cout << "disk write:\t" << disk_write / ops << std::endl;
+  std::cout << "disk read:\t" << disk_read / ops << std::endl;
+  std::cout << "write amplification:\t" << disk_write / logical_write
+            << std::endl;
+  std::cout << "read amplification:\t" << disk_read / logical_read
+            << std::endl;
+  std::cout << "fsyncs:\t" << sum(&Stats::fsyncs) << "\tcompactions:\t"
+            << sum(&Stats::compactions) << std::endl;
+
+  // Per phase: the next phase starts from zero.
+  for (auto &shard : shards_) {
+    if (!shard) continue;
+    for (auto counter : {&Stats::ops, &Stats::logical_write_bytes,
+                         &Stats::disk_write_bytes, &Stats::logical_read_bytes,
+                         &Stats::disk_read_bytes, &Stats::fsyncs,
+                         &Stats::compactions}) {
+      (shard->stats.*counter).store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace ycsbc
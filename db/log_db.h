@@ -0,0 +1,309 @@
+//
+//  log_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_LOG_DB_H_
+#define YCSB_C_LOG_DB_H_
+
+#include "core/db.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "core/properties.h"
+#include "lib/striped_hashtable.h"
+
+#include <seastar/core/file.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/shared_ptr.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/core/temporary_buffer.hh>
+#include <seastar/core/timer.hh>
+
+namespace ycsbc {
+
+///
+/// Reference on-disk engine: a log-structured store in the style of Bitcask.
+///
+/// Every shard appends the records written by its clients to its own log,
+/// a sequence of segment files written with O_DIRECT through an aligned
+/// buffer. A global in-memory index maps each key to the shard, segment and
+/// offset of its latest record; reads go to the owning shard and are served
+/// from the write buffer or with dma_read. Sealed segments whose share of
+/// overwritten records passes a threshold are compacted in the background.
+///
+/// The index is not rebuilt from the log: the store models the I/O path of
+/// a persistent engine, not its recovery. At the end of each phase the DB
+/// prints bytes written and read per operation and the write and read
+/// amplification it saw.
+///
+class LogDB : public DB {
+ public:
+  typedef std::vector<KVPair> Record;
+
+  ///
+  /// Directory for the segment files.
+  ///
+  static const std::string DIR_PROPERTY;
+  static const std::string DIR_DEFAULT;
+
+  ///
+  /// Size in bytes at which the active segment is sealed.
+  ///
+  static const std::string SEGMENT_SIZE_PROPERTY;
+  static const std::string SEGMENT_SIZE_DEFAULT;
+
+  ///
+  /// Size in bytes of each shard's aligned write buffer.
+  ///
+  static const std::string BUFFER_SIZE_PROPERTY;
+  static const std::string BUFFER_SIZE_DEFAULT;
+
+  ///
+  /// When a write reaches the file: "always" before the operation returns
+  /// (the partial tail block is rewritten by later writes), or "full" only
+  /// when the write buffer fills.
+  ///
+  static const std::string FLUSH_PROPERTY;
+  static const std::string FLUSH_DEFAULT;
+
+  ///
+  /// When the file is fsynced: "never", "always" after every write, or
+  /// "interval" every fsync_interval_ms. "always" implies flush=always.
+  ///
+  static const std::string FSYNC_PROPERTY;
+  static const std::string FSYNC_DEFAULT;
+  static const std::string FSYNC_INTERVAL_PROPERTY;
+  static const std::string FSYNC_INTERVAL_DEFAULT;
+
+  ///
+  /// A shard compacts its oldest sealed segment, once every
+  /// compact_interval_ms, while more than compact_ratio of its log is dead.
+  ///
+  static const std::string COMPACT_RATIO_PROPERTY;
+  static const std::string COMPACT_RATIO_DEFAULT;
+  static const std::string COMPACT_INTERVAL_PROPERTY;
+  static const std::string COMPACT_INTERVAL_DEFAULT;
+
+  LogDB(const utils::Properties &props);
+  ///
+  /// Closes the files of all shards, so it must run in a seastar thread.
+  ///
+  ~LogDB();
+
+  ///
+  /// Opens the calling shard's log on first use. Runs in the client's
+  /// seastar thread and blocks it until the log is open.
+  ///
+  void Init();
+  ///
+  /// The last client of a shard flushes (and, unless fsync=never, syncs)
+  /// its log; the last client overall prints the phase's I/O statistics.
+  ///
+  void Close();
+
+  seastar::future<int> Read(const std::string &table, const std::string &key,
+                            const std::vector<std::string> *fields,
+                            std::vector<KVPair> &result);
+
+  seastar::future<int> MultiRead(const std::string &table,
+                                 const std::vector<std::string> &keys,
+                                 const std::vector<std::string> *fields,
+                                 std::vector<std::vector<KVPair>> &result);
+
+  seastar::future<int> Scan(const std::string &table, const std::string &key,
+                            int len, const std::vector<std::string> *fields,
+                            std::vector<std::vector<KVPair>> &result);
+
+  seastar::future<int> Update(const std::string &table, const std::string &key,
+                              std::vector<KVPair> &values);
+
+  seastar::future<int> Insert(const std::string &table, const std::string &key,
+                              std::vector<KVPair> &values);
+
+  seastar::future<int> Delete(const std::string &table,
+                              const std::string &key);
+
+  ///
+  /// Appends the run through the write buffer in whole-buffer writes,
+  /// whatever the flush and fsync policies, and syncs once at the end.
+  ///
+  seastar::future<int> BulkLoad(const std::string &table, RecordRun &run);
+
+ private:
+  typedef std::optional<Record> MaybeRecord;
+
+  enum FlushPolicy { kFlushAlways, kFlushFull };
+  enum SyncPolicy { kSyncNever, kSyncAlways, kSyncInterval };
+
+  ///
+  /// Where the latest entry of a key lives. Immutable once in the index;
+  /// replaced ones are retired through the epoch manager.
+  ///
+  struct Location {
+    unsigned shard;
+    uint32_t segment;
+    uint64_t offset;
+    uint32_t size; ///< Of the whole entry, header included
+
+    bool operator==(const Location &other) const {
+      return shard == other.shard && segment == other.segment &&
+             offset == other.offset;
+    }
+  };
+
+  struct Segment {
+    uint32_t id;
+    std::string path;
+    seastar::file file;
+    uint64_t size = 0;    ///< Bytes of entries, excluding block padding
+    seastar::gate reads;  ///< Closed before the file is
+  };
+
+  ///
+  /// Relaxed counters, read by whichever shard prints the statistics.
+  ///
+  struct Stats {
+    ///
+    /// Each counter has a single writer, its shard.
+    ///
+    static void Add(std::atomic<uint64_t> &counter, uint64_t n) {
+      counter.store(counter.load(std::memory_order_relaxed) + n,
+                    std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> ops{0};
+    std::atomic<uint64_t> logical_write_bytes{0};
+    std::atomic<uint64_t> disk_write_bytes{0};
+    std::atomic<uint64_t> logical_read_bytes{0};
+    std::atomic<uint64_t> disk_read_bytes{0};
+    std::atomic<uint64_t> fsyncs{0};
+    std::atomic<uint64_t> compactions{0};
+  };
+
+  ///
+  /// A shard's log. Only its own shard touches it, except for dead_bytes
+  /// and stats.
+  ///
+  struct alignas(64) Shard {
+    std::map<uint32_t, seastar::lw_shared_ptr<Segment>> segments;
+    seastar::lw_shared_ptr<Segment> active;
+    uint32_t next_segment = 0;
+
+    ///
+    /// Entries not yet written, or written only as part of a partial block.
+    /// buffer[0] is at file offset buffer_pos, which is block-aligned.
+    ///
+    seastar::temporary_buffer<char> buffer;
+    uint64_t buffer_pos = 0;
+    std::size_t buffer_len = 0;
+    bool dirty = false;
+    std::size_t alignment = 4096;
+
+    seastar::semaphore write_lock{1};
+    std::optional<seastar::shared_future<>> opened;
+    int clients = 0;
+
+    uint64_t total_bytes = 0; ///< Of all segments
+    std::atomic<uint64_t> dead_bytes{0};
+    bool compacting = false;
+
+    seastar::timer<> compact_timer;
+    seastar::timer<> sync_timer;
+    seastar::gate background;
+
+    Stats stats;
+  };
+
+  ///
+  /// An entry found live in a segment under compaction.
+  ///
+  struct LiveEntry {
+    std::string key;
+    Location location;
+    std::string bytes;
+  };
+
+  Shard &local_shard() { return *shards_[seastar::this_shard_id()]; }
+
+  seastar::future<> OpenShard(Shard &shard);
+  seastar::future<> StopShard(Shard &shard);
+  seastar::future<> OpenSegment(Shard &shard);
+  seastar::future<> SealSegment(Shard &shard);
+
+  ///
+  /// Appends an encoded entry to the calling shard's log. Unless durable
+  /// is false, the entry is flushed and fsynced as the policies say.
+  ///
+  seastar::future<Location> Append(Shard &shard, std::string entry,
+                                   bool durable = true);
+  ///
+  /// Write out the buffer and fsync the active segment. The caller holds
+  /// the shard's write_lock.
+  ///
+  seastar::future<> Flush(Shard &shard);
+  seastar::future<> Fsync(Shard &shard);
+  ///
+  /// Flushes, and optionally fsyncs, under the shard's write_lock.
+  ///
+  seastar::future<> Sync(Shard &shard, bool fsync);
+
+  ///
+  /// Reads the record at loc on its shard, or nullopt if loc has been
+  /// compacted away and the index should be consulted again.
+  ///
+  seastar::future<MaybeRecord> ReadAt(const Location &loc);
+  seastar::future<MaybeRecord> ReadLocal(const Location &loc);
+  ///
+  /// Reads the latest record of key, or nullopt if there is none.
+  ///
+  seastar::future<MaybeRecord> Fetch(const std::string &key);
+  seastar::future<> FetchAll(const std::vector<std::string> &keys,
+                             std::vector<MaybeRecord> &records);
+
+  bool Find(const char *key, Location *loc);
+  ///
+  /// Points key at loc if it still points at expected (NULL: is absent).
+  ///
+  bool Publish(const char *key, const Location *expected,
+               const Location &loc);
+  ///
+  /// Removes key from the index; returns false if it was not there.
+  ///
+  bool Unpublish(const char *key);
+  void MarkDead(const Location &loc);
+
+  void MaybeCompact(Shard &shard);
+  seastar::future<> Compact(Shard &shard);
+
+  void PrintStats();
+
+  static const size_t kNumRecordLocks = 1024;
+  std::mutex &RecordLock(const char *key);
+
+  std::string dir_;
+  uint64_t segment_size_;
+  std::size_t buffer_size_;
+  FlushPolicy flush_;
+  SyncPolicy sync_;
+  unsigned sync_interval_ms_;
+  double compact_ratio_;
+  unsigned compact_interval_ms_;
+
+  vmp::StripedHashtable<Location *> index_;
+  std::mutex record_locks_[kNumRecordLocks];
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<int> active_clients_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_LOG_DB_H_
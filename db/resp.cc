@@ -0,0 +1,130 @@
+//
+//  resp.cc
+//  YCSB-C
+//
+
+#include "db/resp.h"
+
+#include "core/utils.h"
+
+using std::string;
+using std::vector;
+
+namespace ycsbc {
+namespace resp {
+
+void AppendArray(string &out, size_t n) {
+  out.append("*").append(std::to_string(n)).append("\r\n");
+}
+
+void AppendBulk(string &out, const string &s) {
+  out.append("$").append(std::to_string(s.size())).append("\r\n");
+  out.append(s).append("\r\n");
+}
+
+void AppendNil(string &out) {
+  out.append("$-1\r\n");
+}
+
+void AppendInteger(string &out, int64_t n) {
+  out.append(":").append(std::to_string(n)).append("\r\n");
+}
+
+void AppendString(string &out, const string &s) {
+  out.append("+").append(s).append("\r\n");
+}
+
+void AppendError(string &out, const string &message) {
+  out.append("-").append(message).append("\r\n");
+}
+
+void AppendCommand(string &out, const vector<string> &args) {
+  AppendArray(out, args.size());
+  for (const string &arg : args) AppendBulk(out, arg);
+}
+
+bool Reader::Fill() {
+  seastar::temporary_buffer<char> buf = in_.read().get();
+  if (buf.empty()) return false;
+  buffer_.erase(0, pos_);
+  pos_ = 0;
+  buffer_.append(buf.get(), buf.size());
+  return true;
+}
+
+bool Reader::ReadLine(string &line) {
+  size_t end;
+  while ((end = buffer_.find("\r\n", pos_)) == string::npos) {
+    if (!Fill()) {
+      if (buffered()) throw utils::Exception("RESP stream ended mid-line");
+      return false;
+    }
+  }
+  line.assign(buffer_, pos_, end - pos_);
+  pos_ = end + 2;
+  return true;
+}
+
+void Reader::ReadBytes(size_t n, string &out) {
+  while (buffer_.size() - pos_ < n) {
+    if (!Fill()) throw utils::Exception("RESP stream ended mid-string");
+  }
+  out.assign(buffer_, pos_, n);
+  pos_ += n;
+}
+
+bool Reader::Read(Reply &reply) {
+  string line;
+  if (!ReadLine(line)) return false;
+  if (line.empty()) throw utils::Exception("Empty RESP line");
+  reply.str.clear();
+  reply.elements.clear();
+  const string rest = line.substr(1);
+  switch (line[0]) {
+    case '+':
+      reply.type = Reply::kString;
+      reply.str = rest;
+      return true;
+    case '-':
+      reply.type = Reply::kError;
+      reply.str = rest;
+      return true;
+    case ':':
+      reply.type = Reply::kInteger;
+      reply.integer = std::stoll(rest);
+      return true;
+    case '$': {
+      int64_t n = std::stoll(rest);
+      if (n < 0) {
+        reply.type = Reply::kNil;
+        return true;
+      }
+      reply.type = Reply::kBulk;
+      ReadBytes(n, reply.str);
+      string crlf;
+      ReadBytes(2, crlf);
+      if (crlf != "\r\n") throw utils::Exception("Unterminated RESP string");
+      return true;
+    }
+    case '*': {
+      int64_t n = std::stoll(rest);
+      if (n < 0) {
+        reply.type = Reply::kNil;
+        return true;
+      }
+      reply.type = Reply::kArray;
+      reply.elements.resize(n);
+      for (Reply &element : reply.elements) {
+        if (!Read(element)) {
+          throw utils::Exception("RESP stream ended mid-array");
+        }
+      }
+      return true;
+    }
+    default:
+      throw utils::Exception("Unknown RESP type: " + line);
+  }
+}
+
+} // resp
+} // ycsbc
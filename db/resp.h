@@ -0,0 +1,75 @@
+//
+//  resp.h
+//  YCSB-C
+//
+//  The parts of the Redis serialization protocol (RESP2) that RespDB and
+//  RespServer speak: commands are arrays of bulk strings, replies any of
+//  the five RESP types.
+//
+
+#ifndef YCSB_C_RESP_H_
+#define YCSB_C_RESP_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <seastar/core/iostream.hh>
+
+namespace ycsbc {
+namespace resp {
+
+struct Reply {
+  enum Type { kString, kError, kInteger, kBulk, kNil, kArray };
+
+  Type type = kNil;
+  std::string str;  ///< Of kString, kError and kBulk
+  int64_t integer = 0;
+  std::vector<Reply> elements;
+};
+
+void AppendArray(std::string &out, size_t n);
+void AppendBulk(std::string &out, const std::string &s);
+void AppendNil(std::string &out);
+void AppendInteger(std::string &out, int64_t n);
+void AppendString(std::string &out, const std::string &s);
+void AppendError(std::string &out, const std::string &message);
+
+///
+/// Appends a command: args[0] is its name.
+///
+void AppendCommand(std::string &out, const std::vector<std::string> &args);
+
+///
+/// Parses replies (or commands, which are array replies) off a stream.
+/// Blocks the calling seastar thread while it waits for data.
+///
+class Reader {
+ public:
+  explicit Reader(seastar::input_stream<char> &in) : in_(in), pos_(0) { }
+
+  ///
+  /// Returns false if the stream ended cleanly before the next reply.
+  /// Throws utils::Exception on malformed input or an end mid-reply.
+  ///
+  bool Read(Reply &reply);
+  ///
+  /// Whether bytes of a further reply are already buffered, so a server
+  /// can hold back its answers until a pipelined batch is through.
+  ///
+  bool buffered() const { return pos_ < buffer_.size(); }
+
+ private:
+  bool Fill();
+  bool ReadLine(std::string &line);
+  void ReadBytes(size_t n, std::string &out);
+
+  seastar::input_stream<char> &in_;
+  std::string buffer_;
+  size_t pos_;
+};
+
+} // resp
+} // ycsbc
+
+#endif // YCSB_C_RESP_H_
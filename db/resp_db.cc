@@ -0,0 +1,239 @@
+//
+//  resp_db.cc
+//  YCSB-C
+//
+
+#include "db/resp_db.h"
+
+#include <utility>
+#include "core/utils.h"
+
+#include <seastar/core/loop.hh>
+#include <seastar/core/thread.hh>
+
+using std::string;
+using std::vector;
+
+namespace ycsbc {
+
+const string RespDB::HOST_PROPERTY = "resp.host";
+const string RespDB::HOST_DEFAULT = "127.0.0.1";
+const string RespDB::PORT_PROPERTY = "resp.port";
+const string RespDB::PORT_DEFAULT = "6379";
+const string RespDB::CONNECTIONS_PROPERTY = "resp.connections";
+const string RespDB::CONNECTIONS_DEFAULT = "1";
+const string RespDB::PIPELINE_PROPERTY = "resp.pipeline";
+const string RespDB::PIPELINE_DEFAULT = "64";
+const string RespDB::SERVER_PROPERTY = "resp.server";
+const string RespDB::SERVER_DEFAULT = "false";
+
+RespDB::RespDB(const utils::Properties &props)
+    : host_(props.GetProperty(HOST_PROPERTY, HOST_DEFAULT)),
+      port_(std::stoi(props.GetProperty(PORT_PROPERTY, PORT_DEFAULT))),
+      num_connections_(std::stoul(
+          props.GetProperty(CONNECTIONS_PROPERTY, CONNECTIONS_DEFAULT))),
+      pipeline_(std::stoul(
+          props.GetProperty(PIPELINE_PROPERTY, PIPELINE_DEFAULT))),
+      shards_(seastar::smp::count) {
+  if (num_connections_ == 0 || pipeline_ == 0) {
+    throw utils::Exception("resp.connections and resp.pipeline must be > 0");
+  }
+  if (utils::StrToBool(props.GetProperty(SERVER_PROPERTY, SERVER_DEFAULT))) {
+    server_ = std::make_unique<RespServer>(port_);
+    server_->Start();
+  }
+}
+
+RespDB::~RespDB() {
+  seastar::smp::invoke_on_all([this] {
+    if (!shards_[seastar::this_shard_id()]) {
+      return seastar::make_ready_future<>();
+    }
+    return StopShard(local_shard()).then([this] {
+      shards_[seastar::this_shard_id()].reset();
+    });
+  }).get();
+  if (server_) server_->Stop();
+}
+
+void RespDB::Init() {
+  std::unique_ptr<Shard> &shard = shards_[seastar::this_shard_id()];
+  if (!shard) {
+    shard = std::make_unique<Shard>();
+    shard->opened = seastar::shared_future<>(OpenShard(*shard));
+  }
+  shard->opened->get_future().get();
+}
+
+seastar::future<> RespDB::OpenShard(Shard &shard) {
+  return seastar::async([this, &shard] {
+    for (size_t i = 0; i < num_connections_; ++i) {
+      seastar::connected_socket socket = seastar::connect(
+          seastar::make_ipv4_address(seastar::ipv4_addr(host_, port_))).get();
+      socket.set_nodelay(true);
+      shard.connections.push_back(
+          std::make_unique<Connection>(std::move(socket), pipeline_));
+      Connection *conn = shard.connections.back().get();
+      conn->reader = seastar::async([conn] { ReadReplies(*conn); });
+    }
+  });
+}
+
+seastar::future<> RespDB::StopShard(Shard &shard) {
+  return seastar::parallel_for_each(shard.connections,
+                                    [](std::unique_ptr<Connection> &conn) {
+    return std::exchange(conn->writes, seastar::make_ready_future<>())
+        .handle_exception([](std::exception_ptr) { })
+        .then([&conn] { return conn->out.close(); })
+        .handle_exception([](std::exception_ptr) { })
+        .then([&conn] {
+      // The server hangs up once our side is closed, ending the reader.
+      return std::move(*conn->reader);
+    }).then([&conn] { return conn->in.close(); });
+  });
+}
+
+void RespDB::ReadReplies(Connection &conn) {
+  resp::Reader reader(conn.in);
+  resp::Reply reply;
+  try {
+    while (reader.Read(reply)) {
+      if (conn.waiting.empty()) {
+        throw utils::Exception("Unsolicited RESP reply");
+      }
+      conn.waiting.front().set_value(std::move(reply));
+      conn.waiting.pop_front();
+    }
+    throw utils::Exception("RESP server closed the connection");
+  } catch (...) {
+    conn.error = std::current_exception();
+    for (auto &waiting : conn.waiting) waiting.set_exception(conn.error);
+    conn.waiting.clear();
+  }
+}
+
+seastar::future<vector<resp::Reply>> RespDB::Send(
+    vector<vector<string>> commands) {
+  Shard &shard = local_shard();
+  Connection &conn = *shard.connections[shard.next++ % num_connections_];
+  // A batch larger than the pipeline takes the whole pipeline.
+  const size_t slots = std::min(commands.size(), pipeline_);
+  return conn.window.wait(slots).then(
+      [&conn, slots, commands = std::move(commands)] {
+    if (conn.error) {
+      conn.window.signal(slots);
+      return seastar::make_exception_future<vector<resp::Reply>>(conn.error);
+    }
+    string data;
+    vector<seastar::future<resp::Reply>> replies;
+    for (const vector<string> &command : commands) {
+      resp::AppendCommand(data, command);
+      conn.waiting.emplace_back();
+      replies.push_back(conn.waiting.back().get_future());
+    }
+    // Requests go out in the order their replies are awaited.
+    conn.writes = conn.writes.then([&conn, data = std::move(data)] {
+      return conn.out.write(data).then([&conn] { return conn.out.flush(); });
+    });
+    return seastar::when_all_succeed(replies.begin(), replies.end())
+        .finally([&conn, slots] { conn.window.signal(slots); });
+  });
+}
+
+seastar::future<resp::Reply> RespDB::Send(vector<string> command) {
+  vector<vector<string>> commands;
+  commands.push_back(std::move(command));
+  return Send(std::move(commands)).then([](vector<resp::Reply> replies) {
+    return std::move(replies.front());
+  });
+}
+
+vector<string> RespDB::ReadCommand(const string &key,
+                                   const vector<string> *fields) {
+  if (!fields) return {"HGETALL", key};
+  vector<string> command = {"HMGET", key};
+  command.insert(command.end(), fields->begin(), fields->end());
+  return command;
+}
+
+int RespDB::ToRecord(const resp::Reply &reply, const vector<string> *fields,
+                     vector<KVPair> &result) {
+  if (reply.type == resp::Reply::kError) throw utils::Exception(reply.str);
+  if (reply.type != resp::Reply::kArray) {
+    throw utils::Exception("Unexpected RESP reply to a read");
+  }
+  const vector<resp::Reply> &elements = reply.elements;
+  if (fields) {
+    for (size_t i = 0; i < fields->size() && i < elements.size(); ++i) {
+      if (elements[i].type != resp::Reply::kBulk) continue;
+      result.emplace_back((*fields)[i], elements[i].str);
+    }
+  } else {
+    for (size_t i = 0; i + 1 < elements.size(); i += 2) {
+      result.emplace_back(elements[i].str, elements[i + 1].str);
+    }
+  }
+  return result.empty() ? kErrorNoData : kOK;
+}
+
+seastar::future<int> RespDB::Read(const string &table, const string &key,
+                                  const vector<string> *fields,
+                                  vector<KVPair> &result) {
+  return Send(ReadCommand(key, fields)).then(
+      [fields, &result](resp::Reply reply) {
+    return ToRecord(reply, fields, result);
+  });
+}
+
+seastar::future<int> RespDB::MultiRead(const string &table,
+                                       const vector<string> &keys,
+                                       const vector<string> *fields,
+                                       vector<vector<KVPair>> &result) {
+  vector<vector<string>> commands;
+  for (const string &key : keys) commands.push_back(ReadCommand(key, fields));
+  result.resize(keys.size());
+  return Send(std::move(commands)).then(
+      [fields, &result](vector<resp::Reply> replies) {
+    int status = kOK;
+    for (size_t i = 0; i < replies.size(); ++i) {
+      if (ToRecord(replies[i], fields, result[i]) != kOK) {
+        status = kErrorNoData;
+      }
+    }
+    return status;
+  });
+}
+
+seastar::future<int> RespDB::Scan(const string &table, const string &key,
+                                  int len, const vector<string> *fields,
+                                  vector<vector<KVPair>> &result) {
+  return seastar::make_exception_future<int>(
+      utils::Exception("RespDB does not support Scan"));
+}
+
+seastar::future<int> RespDB::Update(const string &table, const string &key,
+                                    vector<KVPair> &values) {
+  vector<string> command = {"HSET", key};
+  for (const KVPair &pair : values) {
+    command.push_back(pair.first);
+    command.push_back(pair.second);
+  }
+  return Send(std::move(command)).then([](resp::Reply reply) {
+    if (reply.type == resp::Reply::kError) throw utils::Exception(reply.str);
+    return kOK;
+  });
+}
+
+seastar::future<int> RespDB::Insert(const string &table, const string &key,
+                                    vector<KVPair> &values) {
+  return Update(table, key, values);
+}
+
+seastar::future<int> RespDB::Delete(const string &table, const string &key) {
+  return Send(vector<string>{"DEL", key}).then([](resp::Reply reply) {
+    if (reply.type == resp::Reply::kError) throw utils::Exception(reply.str);
+    return reply.integer > 0 ? kOK : kErrorNoData;
+  });
+}
+
+}  // namespace ycsbc
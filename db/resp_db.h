@@ -0,0 +1,169 @@
+//
+//  resp_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_RESP_DB_H_
+#define YCSB_C_RESP_DB_H_
+
+#include "core/db.h"
+
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "core/properties.h"
+#include "db/resp.h"
+#include "db/resp_server.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/net/api.hh>
+
+namespace ycsbc {
+
+///
+/// Client of a Redis-protocol server. A record is a hash: Insert() and
+/// Update() are HSET, Read() is HGETALL or HMGET, Delete() is DEL. Scan()
+/// is not supported, as Redis hashes have no key order.
+///
+/// Every shard keeps its own pool of connections, opened by the first
+/// client on the shard and used round-robin. Requests are pipelined: each
+/// connection has up to resp.pipeline requests in flight, and a reader
+/// thread hands replies back in order. MultiRead() sends the reads of all
+/// its keys back to back in one write and waits once, the hash equivalent
+/// of MGET.
+///
+class RespDB : public DB {
+ public:
+  ///
+  /// Server address; the host is a dotted IPv4 address.
+  ///
+  static const std::string HOST_PROPERTY;
+  static const std::string HOST_DEFAULT;
+  static const std::string PORT_PROPERTY;
+  static const std::string PORT_DEFAULT;
+
+  ///
+  /// Connections per shard.
+  ///
+  static const std::string CONNECTIONS_PROPERTY;
+  static const std::string CONNECTIONS_DEFAULT;
+
+  ///
+  /// Requests in flight per connection.
+  ///
+  static const std::string PIPELINE_PROPERTY;
+  static const std::string PIPELINE_DEFAULT;
+
+  ///
+  /// If true, a RespServer over a StripedDB is started in this process on
+  /// resp.port, to benchmark the protocol path without a Redis.
+  ///
+  static const std::string SERVER_PROPERTY;
+  static const std::string SERVER_DEFAULT;
+
+  ///
+  /// Must run in a seastar thread when resp.server is set.
+  ///
+  RespDB(const utils::Properties &props);
+  ///
+  /// Closes the connections of all shards, so it must run in a seastar
+  /// thread.
+  ///
+  ~RespDB();
+
+  ///
+  /// Connects the calling shard's pool on first use. Runs in the client's
+  /// seastar thread and blocks it until the pool is connected.
+  ///
+  void Init();
+
+  seastar::future<int> Read(const std::string &table, const std::string &key,
+                            const std::vector<std::string> *fields,
+                            std::vector<KVPair> &result);
+
+  seastar::future<int> MultiRead(const std::string &table,
+                                 const std::vector<std::string> &keys,
+                                 const std::vector<std::string> *fields,
+                                 std::vector<std::vector<KVPair>> &result);
+
+  seastar::future<int> Scan(const std::string &table, const std::string &key,
+                            int len, const std::vector<std::string> *fields,
+                            std::vector<std::vector<KVPair>> &result);
+
+  seastar::future<int> Update(const std::string &table, const std::string &key,
+                              std::vector<KVPair> &values);
+
+  seastar::future<int> Insert(const std::string &table, const std::string &key,
+                              std::vector<KVPair> &values);
+
+  seastar::future<int> Delete(const std::string &table,
+                              const std::string &key);
+
+ private:
+  struct Connection {
+    Connection(seastar::connected_socket s, size_t pipeline)
+        : socket(std::move(s)), in(socket.input()), out(socket.output()),
+          window(pipeline) { }
+
+    seastar::connected_socket socket;
+    seastar::input_stream<char> in;
+    seastar::output_stream<char> out;
+    seastar::semaphore window;  ///< Free pipeline slots
+    seastar::future<> writes = seastar::make_ready_future<>();
+    std::deque<seastar::promise<resp::Reply>> waiting;
+    std::optional<seastar::future<>> reader;
+    std::exception_ptr error;  ///< Why the connection broke, if it did
+  };
+
+  struct alignas(64) Shard {
+    std::vector<std::unique_ptr<Connection>> connections;
+    size_t next = 0;
+    std::optional<seastar::shared_future<>> opened;
+  };
+
+  Shard &local_shard() { return *shards_[seastar::this_shard_id()]; }
+
+  seastar::future<> OpenShard(Shard &shard);
+  seastar::future<> StopShard(Shard &shard);
+  ///
+  /// Hands replies to the waiting requests of conn, in order, until the
+  /// connection ends. Runs in a seastar thread.
+  ///
+  static void ReadReplies(Connection &conn);
+
+  ///
+  /// Sends the commands back to back on one of the calling shard's
+  /// connections; resolves to their replies, in order.
+  ///
+  seastar::future<std::vector<resp::Reply>> Send(
+      std::vector<std::vector<std::string>> commands);
+  seastar::future<resp::Reply> Send(std::vector<std::string> command);
+
+  static std::vector<std::string> ReadCommand(
+      const std::string &key, const std::vector<std::string> *fields);
+  ///
+  /// Fills result from the reply to ReadCommand(); returns kErrorNoData if
+  /// the record does not exist.
+  ///
+  static int ToRecord(const resp::Reply &reply,
+                      const std::vector<std::string> *fields,
+                      std::vector<KVPair> &result);
+
+  std::string host_;
+  uint16_t port_;
+  size_t num_connections_;
+  size_t pipeline_;
+  std::unique_ptr<RespServer> server_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_RESP_DB_H_
@@ -0,0 +1,152 @@
+//
+//  resp_server.cc
+//  YCSB-C
+//
+
+#include "db/resp_server.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+#include <seastar/core/loop.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/core/thread.hh>
+
+using std::string;
+using std::vector;
+
+namespace ycsbc {
+
+namespace {
+
+const string kTable = "usertable";
+
+}  // namespace
+
+RespServer::RespServer(uint16_t port)
+    : port_(port), shards_(seastar::smp::count) {
+}
+
+void RespServer::Start() {
+  seastar::smp::invoke_on_all([this] {
+    std::unique_ptr<Shard> &shard = shards_[seastar::this_shard_id()];
+    shard = std::make_unique<Shard>();
+    seastar::listen_options options;
+    options.reuse_address = true;
+    shard->listener = seastar::listen(
+        seastar::make_ipv4_address(seastar::ipv4_addr(port_)), options);
+    shard->accepting = Accept(*shard);
+  }).get();
+}
+
+void RespServer::Stop() {
+  seastar::smp::invoke_on_all([this] {
+    Shard &shard = *shards_[seastar::this_shard_id()];
+    shard.listener->abort_accept();
+    return std::move(*shard.accepting).then([&shard] {
+      return shard.connections.close();
+    });
+  }).get();
+}
+
+seastar::future<> RespServer::Accept(Shard &shard) {
+  return seastar::keep_doing([this, &shard] {
+    return shard.listener->accept().then(
+        [this, &shard](seastar::accept_result accepted) {
+      (void)seastar::with_gate(shard.connections,
+          [this, socket = std::move(accepted.connection)]() mutable {
+        return seastar::async([this, socket = std::move(socket)]() mutable {
+          Serve(std::move(socket));
+        });
+      });
+    });
+  }).handle_exception([](std::exception_ptr) {
+    // abort_accept() ends the loop with an exception.
+  });
+}
+
+void RespServer::Serve(seastar::connected_socket socket) {
+  seastar::input_stream<char> in = socket.input();
+  seastar::output_stream<char> out = socket.output();
+  resp::Reader reader(in);
+  resp::Reply command;
+  string replies;
+  try {
+    while (reader.Read(command)) {
+      Execute(command, replies);
+      if (!reader.buffered()) {
+        out.write(replies).get();
+        out.flush().get();
+        replies.clear();
+      }
+    }
+  } catch (std::exception &e) {
+    std::cerr << "RESP server: " << e.what() << std::endl;
+  }
+  out.close().get();
+  in.close().get();
+}
+
+void RespServer::Execute(const resp::Reply &command, string &out) {
+  vector<string> args;
+  if (command.type == resp::Reply::kArray) {
+    for (const resp::Reply &arg : command.elements) {
+      if (arg.type != resp::Reply::kBulk) break;
+      args.push_back(arg.str);
+    }
+  }
+  if (args.empty() || args.size() != command.elements.size()) {
+    resp::AppendError(out, "ERR commands are arrays of bulk strings");
+    return;
+  }
+  string name = args[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  if (name == "PING") {
+    resp::AppendString(out, "PONG");
+  } else if (name == "HSET" && args.size() >= 4 && args.size() % 2 == 0) {
+    vector<DB::KVPair> values;
+    for (size_t i = 2; i < args.size(); i += 2) {
+      values.emplace_back(args[i], args[i + 1]);
+    }
+    // Update() and Insert() each fail if the other got there first.
+    while (db_.Update(kTable, args[1], values).get() == DB::kErrorNoData &&
+           db_.Insert(kTable, args[1], values).get() == DB::kErrorConflict) {
+    }
+    resp::AppendInteger(out, values.size());
+  } else if (name == "HGETALL" && args.size() == 2) {
+    vector<DB::KVPair> record;
+    db_.Read(kTable, args[1], NULL, record).get();
+    resp::AppendArray(out, record.size() * 2);
+    for (const DB::KVPair &pair : record) {
+      resp::AppendBulk(out, pair.first);
+      resp::AppendBulk(out, pair.second);
+    }
+  } else if (name == "HMGET" && args.size() >= 3) {
+    vector<string> fields(args.begin() + 2, args.end());
+    vector<DB::KVPair> record;
+    db_.Read(kTable, args[1], &fields, record).get();
+    resp::AppendArray(out, fields.size());
+    for (const string &field : fields) {
+      auto it = std::find_if(record.begin(), record.end(),
+          [&field](const DB::KVPair &pair) { return pair.first == field; });
+      if (it == record.end()) {
+        resp::AppendNil(out);
+      } else {
+        resp::AppendBulk(out, it->second);
+      }
+    }
+  } else if (name == "DEL" && args.size() >= 2) {
+    int64_t deleted = 0;
+    for (size_t i = 1; i < args.size(); ++i) {
+      deleted += db_.Delete(kTable, args[i]).get() == DB::kOK;
+    }
+    resp::AppendInteger(out, deleted);
+  } else {
+    resp::AppendError(out, "ERR unknown command or wrong number of "
+                           "arguments for '" + args[0] + "'");
+  }
+}
+
+}  // namespace ycsbc
@@ -0,0 +1,64 @@
+//
+//  resp_server.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_RESP_SERVER_H_
+#define YCSB_C_RESP_SERVER_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "db/resp.h"
+#include "db/striped_db.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/net/api.hh>
+
+namespace ycsbc {
+
+///
+/// A stand-in for a Redis front end, so that RespDB can be benchmarked and
+/// tested without one: listens on every shard and serves HSET, HGETALL,
+/// HMGET, DEL and PING from a StripedDB. Replies to a pipelined batch go out
+/// in one write once the batch has been read.
+///
+class RespServer {
+ public:
+  explicit RespServer(uint16_t port);
+
+  ///
+  /// Listens on every shard. Blocks the calling seastar thread.
+  ///
+  void Start();
+  ///
+  /// Stops accepting and waits until every client has hung up. Blocks the
+  /// calling seastar thread.
+  ///
+  void Stop();
+
+ private:
+  struct Shard {
+    std::optional<seastar::server_socket> listener;
+    std::optional<seastar::future<>> accepting;
+    seastar::gate connections;
+  };
+
+  seastar::future<> Accept(Shard &shard);
+  ///
+  /// Runs in a seastar thread per connection.
+  ///
+  void Serve(seastar::connected_socket socket);
+  void Execute(const resp::Reply &command, std::string &out);
+
+  StripedDB db_;
+  const uint16_t port_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_RESP_SERVER_H_
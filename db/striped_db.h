@@ -0,0 +1,22 @@
+//
+//  striped_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_STRIPED_DB_H_
+#define YCSB_C_STRIPED_DB_H_
+
+#include "db/hashtable_db.h"
+
+#include "lib/striped_hashtable.h"
+
+namespace ycsbc {
+
+class StripedDB : public HashtableDB {
+ public:
+  StripedDB() : HashtableDB(new vmp::StripedHashtable<Record *>) { }
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_STRIPED_DB_H_
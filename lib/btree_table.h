@@ -0,0 +1,368 @@
+//
+//  btree_table.h
+//  YCSB-C
+//
+//  An in-memory B+tree keyed by C strings. It offers the StringHashtable
+//  interface, but Entries() and Iterator walk keys in ascending strcmp order,
+//  so range scans return the records that actually follow the start key.
+//
+
+#ifndef YCSB_C_LIB_BTREE_TABLE_H_
+#define YCSB_C_LIB_BTREE_TABLE_H_
+
+#include "lib/string_hashtable.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "lib/epoch.h"
+#include "lib/mem_alloc.h"
+#include "lib/string.h"
+
+namespace vmp {
+
+template <class V, class MA = MemAlloc>
+class BTreeTable : public StringHashtable<V> {
+ public:
+  typedef typename StringHashtable<V>::KVPair KVPair;
+  class Iterator;
+
+  BTreeTable() : root_(NewLeaf()), size_(0) { }
+  ~BTreeTable() { DeleteNode(root_); }
+
+  BTreeTable(const BTreeTable &) = delete;
+  BTreeTable &operator=(const BTreeTable &) = delete;
+
+  V Get(const char *key) const; ///< Returns NULL if the key is not found
+  bool Insert(const char *key, V value);
+  V Update(const char *key, V value);
+  V Remove(const char *key);
+  std::vector<KVPair> Entries(const char *key = NULL,
+                              std::size_t n = -1) const;
+  std::size_t Size() const { return size_; }
+
+  Iterator Begin() const;
+  Iterator LowerBound(const char *key) const; ///< First key not less than key
+
+ private:
+  ///
+  /// Slots per node. Each node keeps an 8-byte big-endian key prefix array
+  /// next to the key array, so the binary search touches two cache lines
+  /// and dereferences the full key only when prefixes tie.
+  ///
+  static const int kSlots = 16;
+
+  struct Probe {
+    explicit Probe(const char *k) : key(k), prefix(Prefix(k)) { }
+    const char *key;
+    uint64_t prefix;
+  };
+
+  struct Node {
+    explicit Node(bool is_leaf) : leaf(is_leaf), count(0) { }
+    bool leaf;
+    int count;
+    uint64_t prefixes[kSlots + 1]; ///< One spare slot for overflow on insert
+    String keys[kSlots + 1];
+  };
+
+  struct Leaf : public Node {
+    Leaf() : Node(true), next(NULL) { }
+    V values[kSlots + 1];
+    Leaf *next;
+  };
+
+  struct Inner : public Node {
+    Inner() : Node(false) { }
+    Node *children[kSlots + 2];
+  };
+
+  static uint64_t Prefix(const char *key);
+  static int Compare(const Probe &probe, const Node *node, int i);
+  static int LowerIndex(const Node *node, const Probe &probe);
+  static int UpperIndex(const Node *node, const Probe &probe);
+
+  static Leaf *NewLeaf() { return MA::template New<Leaf>(); }
+  static Inner *NewInner() { return MA::template New<Inner>(); }
+  static void DeleteNode(Node *node);
+
+  Leaf *FindLeaf(const Probe &probe) const;
+  ///
+  /// Inserts into the subtree rooted at node. If the node overflows it is
+  /// split, and the new right sibling and its separator key are returned
+  /// through split_node and split_key.
+  ///
+  bool InsertAt(Node *node, const Probe &probe, V value,
+                Node **split_node, String *split_key);
+  static void SetSlot(Node *node, int i, const String &key);
+  static void ShiftRight(Node *node, int from);
+
+  Node *root_;
+  std::size_t size_;
+};
+
+template <class V, class MA>
+class BTreeTable<V, MA>::Iterator {
+ public:
+  bool Valid() const { return leaf_ != NULL; }
+  const char *key() const { return leaf_->keys[pos_].value(); }
+  V value() const { return leaf_->values[pos_]; }
+  void Next() { ++pos_; SkipEmpty(); }
+
+ private:
+  friend class BTreeTable<V, MA>;
+  Iterator(const Leaf *leaf, int pos) : leaf_(leaf), pos_(pos) { SkipEmpty(); }
+
+  ///
+  /// Removal does not merge leaves, so empty or exhausted leaves are skipped.
+  ///
+  void SkipEmpty() {
+    while (leaf_ && pos_ >= leaf_->count) {
+      leaf_ = leaf_->next;
+      pos_ = 0;
+    }
+  }
+
+  const Leaf *leaf_;
+  int pos_;
+};
+
+template <class V, class MA>
+inline uint64_t BTreeTable<V, MA>::Prefix(const char *key) {
+  uint64_t prefix = 0;
+  for (int i = 0; i < 8 && key[i] != '\0'; ++i) {
+    prefix |= uint64_t((unsigned char)key[i]) << (56 - 8 * i);
+  }
+  return prefix;
+}
+
+template <class V, class MA>
+inline int BTreeTable<V, MA>::Compare(const Probe &probe, const Node *node,
+                                      int i) {
+  if (probe.prefix != node->prefixes[i]) {
+    return probe.prefix < node->prefixes[i] ? -1 : 1;
+  }
+  return strcmp(probe.key, node->keys[i].value());
+}
+
+template <class V, class MA>
+inline int BTreeTable<V, MA>::LowerIndex(const Node *node,
+                                         const Probe &probe) {
+  int lo = 0, hi = node->count;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (Compare(probe, node, mid) > 0) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+template <class V, class MA>
+inline int BTreeTable<V, MA>::UpperIndex(const Node *node,
+                                         const Probe &probe) {
+  int lo = 0, hi = node->count;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (Compare(probe, node, mid) >= 0) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+template <class V, class MA>
+void BTreeTable<V, MA>::DeleteNode(Node *node) {
+  for (int i = 0; i < node->count; ++i) {
+    String::Free<MA>(node->keys[i]);
+  }
+  if (node->leaf) {
+    MA::Delete(static_cast<Leaf *>(node));
+  } else {
+    Inner *inner = static_cast<Inner *>(node);
+    for (int i = 0; i <= inner->count; ++i) DeleteNode(inner->children[i]);
+    MA::Delete(inner);
+  }
+}
+
+template <class V, class MA>
+typename BTreeTable<V, MA>::Leaf *BTreeTable<V, MA>::FindLeaf(
+    const Probe &probe) const {
+  Node *node = root_;
+  while (!node->leaf) {
+    Inner *inner = static_cast<Inner *>(node);
+    node = inner->children[UpperIndex(inner, probe)];
+  }
+  return static_cast<Leaf *>(node);
+}
+
+template <class V, class MA>
+inline void BTreeTable<V, MA>::SetSlot(Node *node, int i, const String &key) {
+  node->keys[i] = key;
+  node->prefixes[i] = Prefix(key.value());
+}
+
+template <class V, class MA>
+inline void BTreeTable<V, MA>::ShiftRight(Node *node, int from) {
+  for (int i = node->count; i > from; --i) {
+    node->keys[i] = node->keys[i - 1];
+    node->prefixes[i] = node->prefixes[i - 1];
+  }
+}
+
+template <class V, class MA>
+bool BTreeTable<V, MA>::InsertAt(Node *node, const Probe &probe, V value,
+                                 Node **split_node, String *split_key) {
+  *split_node = NULL;
+  if (node->leaf) {
+    Leaf *leaf = static_cast<Leaf *>(node);
+    int pos = LowerIndex(leaf, probe);
+    if (pos < leaf->count && Compare(probe, leaf, pos) == 0) return false;
+
+    ShiftRight(leaf, pos);
+    for (int i = leaf->count; i > pos; --i) {
+      leaf->values[i] = leaf->values[i - 1];
+    }
+    SetSlot(leaf, pos, String::Copy<MA>(probe.key));
+    leaf->values[pos] = value;
+    if (++leaf->count <= kSlots) return true;
+
+    Leaf *right = NewLeaf();
+    int half = leaf->count / 2;
+    for (int i = half; i < leaf->count; ++i) {
+      right->keys[i - half] = leaf->keys[i];
+      right->prefixes[i - half] = leaf->prefixes[i];
+      right->values[i - half] = leaf->values[i];
+    }
+    right->count = leaf->count - half;
+    leaf->count = half;
+    right->next = leaf->next;
+    leaf->next = right;
+    // Separators own a copy so that removing the leaf key cannot free them.
+    *split_key = String::Copy<MA>(right->keys[0].value());
+    *split_node = right;
+    return true;
+  }
+
+  Inner *inner = static_cast<Inner *>(node);
+  int pos = UpperIndex(inner, probe);
+  Node *child_split = NULL;
+  String child_key;
+  if (!InsertAt(inner->children[pos], probe, value, &child_split, &child_key)) {
+    return false;
+  }
+  if (!child_split) return true;
+
+  ShiftRight(inner, pos);
+  for (int i = inner->count + 1; i > pos + 1; --i) {
+    inner->children[i] = inner->children[i - 1];
+  }
+  SetSlot(inner, pos, child_key);
+  inner->children[pos + 1] = child_split;
+  if (++inner->count <= kSlots) return true;
+
+  // The middle separator moves up; it is not kept in either half.
+  Inner *right = NewInner();
+  int mid = inner->count / 2;
+  for (int i = mid + 1; i < inner->count; ++i) {
+    right->keys[i - mid - 1] = inner->keys[i];
+    right->prefixes[i - mid - 1] = inner->prefixes[i];
+  }
+  for (int i = mid + 1; i <= inner->count; ++i) {
+    right->children[i - mid - 1] = inner->children[i];
+  }
+  right->count = inner->count - mid - 1;
+  inner->count = mid;
+  *split_key = inner->keys[mid];
+  *split_node = right;
+  return true;
+}
+
+template <class V, class MA>
+V BTreeTable<V, MA>::Get(const char *key) const {
+  Probe probe(key);
+  const Leaf *leaf = FindLeaf(probe);
+  int pos = LowerIndex(leaf, probe);
+  if (pos == leaf->count || Compare(probe, leaf, pos) != 0) return NULL;
+  return leaf->values[pos];
+}
+
+template <class V, class MA>
+bool BTreeTable<V, MA>::Insert(const char *key, V value) {
+  if (!key) return false;
+  Probe probe(key);
+  Node *split_node;
+  String split_key;
+  if (!InsertAt(root_, probe, value, &split_node, &split_key)) return false;
+  if (split_node) {
+    Inner *root = NewInner();
+    SetSlot(root, 0, split_key);
+    root->children[0] = root_;
+    root->children[1] = split_node;
+    root->count = 1;
+    root_ = root;
+  }
+  ++size_;
+  return true;
+}
+
+template <class V, class MA>
+V BTreeTable<V, MA>::Update(const char *key, V value) {
+  Probe probe(key);
+  Leaf *leaf = FindLeaf(probe);
+  int pos = LowerIndex(leaf, probe);
+  if (pos == leaf->count || Compare(probe, leaf, pos) != 0) return NULL;
+  V old = leaf->values[pos];
+  leaf->values[pos] = value;
+  return old;
+}
+
+template <class V, class MA>
+V BTreeTable<V, MA>::Remove(const char *key) {
+  Probe probe(key);
+  Leaf *leaf = FindLeaf(probe);
+  int pos = LowerIndex(leaf, probe);
+  if (pos == leaf->count || Compare(probe, leaf, pos) != 0) return NULL;
+  V old = leaf->values[pos];
+  // Keys returned by Entries() stay valid for readers inside an EpochGuard.
+  EpochManager::Global().Retire(const_cast<char *>(leaf->keys[pos].value()),
+      leaf->keys[pos].length() + 1, [](void *p, std::size_t size) {
+        MA::Free(static_cast<char *>(p), size);
+      });
+  for (int i = pos + 1; i < leaf->count; ++i) {
+    leaf->keys[i - 1] = leaf->keys[i];
+    leaf->prefixes[i - 1] = leaf->prefixes[i];
+    leaf->values[i - 1] = leaf->values[i];
+  }
+  --leaf->count;
+  --size_;
+  return old;
+}
+
+template <class V, class MA>
+typename BTreeTable<V, MA>::Iterator BTreeTable<V, MA>::Begin() const {
+  Node *node = root_;
+  while (!node->leaf) node = static_cast<Inner *>(node)->children[0];
+  return Iterator(static_cast<Leaf *>(node), 0);
+}
+
+template <class V, class MA>
+typename BTreeTable<V, MA>::Iterator BTreeTable<V, MA>::LowerBound(
+    const char *key) const {
+  Probe probe(key);
+  const Leaf *leaf = FindLeaf(probe);
+  return Iterator(leaf, LowerIndex(leaf, probe));
+}
+
+template <class V, class MA>
+std::vector<typename BTreeTable<V, MA>::KVPair> BTreeTable<V, MA>::Entries(
+    const char *key, std::size_t n) const {
+  std::vector<KVPair> pairs;
+  Iterator it = key ? LowerBound(key) : Begin();
+  for (std::size_t i = 0; it.Valid() && i < n; it.Next(), ++i) {
+    pairs.push_back(std::make_pair(it.key(), it.value()));
+  }
+  return pairs;
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_BTREE_TABLE_H_
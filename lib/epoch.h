@@ -0,0 +1,196 @@
+//
+//  epoch.h
+//  YCSB-C
+//
+//  Epoch-based memory reclamation for the lib/ tables. Readers bracket any
+//  use of a table's keys or values with an EpochGuard; writers hand unlinked
+//  memory to Retire() instead of freeing it. Retired blocks are freed in
+//  batches once every thread that could still see them has left its guard.
+//
+//  State is kept per thread, which under seastar means per shard: a shard
+//  announces its epoch in its own cache line and queues retired blocks on
+//  its own list, so neither path is shared across cores.
+//
+
+#ifndef YCSB_C_LIB_EPOCH_H_
+#define YCSB_C_LIB_EPOCH_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace vmp {
+
+class EpochManager {
+ public:
+  typedef void (*FreeFunction)(void *p, std::size_t size);
+
+  static const int kMaxThreads = 256;
+  static const std::size_t kRetireBatch = 64;
+
+  static EpochManager &Global() {
+    static EpochManager manager;
+    return manager;
+  }
+
+  ///
+  /// Enters and leaves a read-side critical section. Calls may nest.
+  /// A guard must not be held across a long wait: it holds back reclamation
+  /// for every thread.
+  ///
+  void Enter();
+  void Exit();
+
+  ///
+  /// Schedules free_fn(p, size) for when no reader can still hold p.
+  /// p must already be unreachable for readers that enter from now on.
+  ///
+  void Retire(void *p, std::size_t size, FreeFunction free_fn);
+
+  template <class T>
+  void RetireObject(T *p) {
+    Retire(p, sizeof(T), [](void *q, std::size_t) { delete (T *)q; });
+  }
+
+  ///
+  /// Tries to advance the epoch and frees whatever has become safe on the
+  /// calling thread. Retire() calls this every kRetireBatch blocks.
+  ///
+  void Reclaim();
+
+ private:
+  struct Retired {
+    void *p;
+    std::size_t size;
+    FreeFunction free_fn;
+    uint64_t epoch;
+  };
+
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> epoch{kQuiescent};
+  };
+
+  ///
+  /// The calling thread's slot, retired list and nesting depth. On thread
+  /// exit, unreclaimed blocks move to orphans_.
+  ///
+  struct Local {
+    Local() : slot(NULL), depth(0) { }
+    ~Local();
+    Slot *slot;
+    int depth;
+    std::vector<Retired> retired;
+  };
+
+  static const uint64_t kQuiescent = 0;
+
+  EpochManager() : epoch_(1), num_slots_(0) { }
+  ~EpochManager() { FreeSafe(orphans_, UINT64_MAX); }
+
+  Local &local();
+  bool TryAdvance();
+  static void FreeSafe(std::vector<Retired> &list, uint64_t epoch);
+
+  std::atomic<uint64_t> epoch_;
+  std::atomic<int> num_slots_;
+  Slot slots_[kMaxThreads];
+
+  std::mutex orphans_mutex_;
+  std::vector<Retired> orphans_;
+};
+
+///
+/// Holds the calling thread inside the global epoch for its lifetime.
+///
+class EpochGuard {
+ public:
+  EpochGuard() { EpochManager::Global().Enter(); }
+  ~EpochGuard() { EpochManager::Global().Exit(); }
+
+  EpochGuard(const EpochGuard &) = delete;
+  EpochGuard &operator=(const EpochGuard &) = delete;
+};
+
+inline EpochManager::Local &EpochManager::local() {
+  static thread_local Local local;
+  if (!local.slot) {
+    int i = num_slots_.fetch_add(1);
+    assert(i < kMaxThreads);
+    local.slot = &slots_[i];
+  }
+  return local;
+}
+
+inline EpochManager::Local::~Local() {
+  if (retired.empty()) return;
+  EpochManager &manager = Global();
+  std::lock_guard<std::mutex> lock(manager.orphans_mutex_);
+  manager.orphans_.insert(manager.orphans_.end(), retired.begin(),
+                          retired.end());
+}
+
+inline void EpochManager::Enter() {
+  Local &l = local();
+  if (l.depth++ > 0) return;
+  l.slot->epoch.store(epoch_.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+  // Publish the epoch before any table memory is read.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+inline void EpochManager::Exit() {
+  Local &l = local();
+  assert(l.depth > 0);
+  if (--l.depth > 0) return;
+  l.slot->epoch.store(kQuiescent, std::memory_order_release);
+}
+
+inline void EpochManager::Retire(void *p, std::size_t size,
+                                 FreeFunction free_fn) {
+  Local &l = local();
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  l.retired.push_back({p, size, free_fn, epoch_.load()});
+  if (l.retired.size() % kRetireBatch == 0) Reclaim();
+}
+
+inline bool EpochManager::TryAdvance() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  uint64_t epoch = epoch_.load();
+  int n = num_slots_.load();
+  for (int i = 0; i < n; ++i) {
+    uint64_t e = slots_[i].epoch.load(std::memory_order_acquire);
+    if (e != kQuiescent && e != epoch) return false;
+  }
+  return epoch_.compare_exchange_strong(epoch, epoch + 1);
+}
+
+inline void EpochManager::FreeSafe(std::vector<Retired> &list,
+                                   uint64_t epoch) {
+  // A block retired in epoch e may be held by readers that entered in e,
+  // and those have all left once the epoch reaches e + 2.
+  std::size_t kept = 0;
+  for (Retired &r : list) {
+    if (r.epoch + 2 <= epoch) {
+      r.free_fn(r.p, r.size);
+    } else {
+      list[kept++] = r;
+    }
+  }
+  list.resize(kept);
+}
+
+inline void EpochManager::Reclaim() {
+  TryAdvance();
+  uint64_t epoch = epoch_.load();
+  FreeSafe(local().retired, epoch);
+
+  std::unique_lock<std::mutex> lock(orphans_mutex_, std::try_to_lock);
+  if (lock.owns_lock() && !orphans_.empty()) FreeSafe(orphans_, epoch);
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_EPOCH_H_
@@ -0,0 +1,114 @@
+//
+//  hash.h
+//  YCSB-C
+//
+//  String hash functions selectable as the H parameter of vmp::BasicString.
+//  Each hasher exposes static uint64_t Hash(const char *data, size_t len).
+//
+
+#ifndef YCSB_C_LIB_HASH_H_
+#define YCSB_C_LIB_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace vmp {
+
+///
+/// The classic byte-at-a-time SDBM hash, kept for comparison.
+///
+struct SDBMHasher {
+  static uint64_t Hash(const char *data, size_t len) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < len; ++i) {
+      uint64_t c = (unsigned char)data[i];
+      hash = c + (hash << 6) + (hash << 16) - hash;
+    }
+    return hash;
+  }
+};
+
+///
+/// A word-at-a-time hash following wyhash (final version 4): inputs up to 16
+/// bytes, such as user<N> keys with insertorder=ordered, take two
+/// overlapping loads and two 64x64->128 bit multiplies. The default hashed
+/// keys, "user" and a 64-bit hash in decimal, run to 24 bytes and take one
+/// more multiply per 16 bytes past the first.
+///
+struct WyHasher {
+  static uint64_t Hash(const char *data, size_t len, uint64_t seed = 0) {
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+    seed ^= Mix(seed ^ kSecret[0], kSecret[1]);
+    uint64_t a, b;
+    if (len <= 16) {
+      if (len >= 4) {
+        a = (Read4(p) << 32) | Read4(p + ((len >> 3) << 2));
+        b = (Read4(p + len - 4) << 32) | Read4(p + len - 4 - ((len >> 3) << 2));
+      } else if (len > 0) {
+        a = Read3(p, len);
+        b = 0;
+      } else {
+        a = b = 0;
+      }
+    } else {
+      size_t i = len;
+      if (i > 48) {
+        uint64_t see1 = seed, see2 = seed;
+        do {
+          seed = Mix(Read8(p) ^ kSecret[1], Read8(p + 8) ^ seed);
+          see1 = Mix(Read8(p + 16) ^ kSecret[2], Read8(p + 24) ^ see1);
+          see2 = Mix(Read8(p + 32) ^ kSecret[3], Read8(p + 40) ^ see2);
+          p += 48;
+          i -= 48;
+        } while (i > 48);
+        seed ^= see1 ^ see2;
+      }
+      while (i > 16) {
+        seed = Mix(Read8(p) ^ kSecret[1], Read8(p + 8) ^ seed);
+        i -= 16;
+        p += 16;
+      }
+      a = Read8(p + i - 16);
+      b = Read8(p + i - 8);
+    }
+    Multiply(a ^ kSecret[1], b ^ seed, &a, &b);
+    return Mix(a ^ kSecret[0] ^ len, b ^ kSecret[1]);
+  }
+
+ private:
+  static constexpr uint64_t kSecret[4] = {
+      0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+      0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+
+  static void Multiply(uint64_t a, uint64_t b, uint64_t *lo, uint64_t *hi) {
+    __uint128_t r = (__uint128_t)a * b;
+    *lo = (uint64_t)r;
+    *hi = (uint64_t)(r >> 64);
+  }
+
+  static uint64_t Mix(uint64_t a, uint64_t b) {
+    Multiply(a, b, &a, &b);
+    return a ^ b;
+  }
+
+  static uint64_t Read8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+  }
+
+  static uint64_t Read4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+  }
+
+  static uint64_t Read3(const uint8_t *p, size_t k) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+  }
+};
+
+} // vmp
+
+#endif // YCSB_C_LIB_HASH_H_
@@ -0,0 +1,76 @@
+//
+//  lock_btree_table.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_LIB_LOCK_BTREE_TABLE_H_
+#define YCSB_C_LIB_LOCK_BTREE_TABLE_H_
+
+#include "lib/btree_table.h"
+
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace vmp {
+
+///
+/// BTreeTable guarded by a reader-writer lock. Point reads and scans share
+/// the lock so that long scans do not serialize each other.
+///
+template<class V>
+class LockBTreeTable : public BTreeTable<V> {
+ public:
+  typedef typename StringHashtable<V>::KVPair KVPair;
+
+  V Get(const char *key) const; ///< Returns NULL if the key is not found
+  bool Insert(const char *key, V value);
+  V Update(const char *key, V value);
+  V Remove(const char *key);
+  std::vector<KVPair> Entries(const char *key = NULL, size_t n = -1) const;
+  std::size_t Size() const;
+
+ private:
+  mutable std::shared_mutex mutex_;
+};
+
+template<class V>
+inline V LockBTreeTable<V>::Get(const char *key) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return BTreeTable<V>::Get(key);
+}
+
+template<class V>
+inline bool LockBTreeTable<V>::Insert(const char *key, V value) {
+  std::lock_guard<std::shared_mutex> lock(mutex_);
+  return BTreeTable<V>::Insert(key, value);
+}
+
+template<class V>
+inline V LockBTreeTable<V>::Update(const char *key, V value) {
+  std::lock_guard<std::shared_mutex> lock(mutex_);
+  return BTreeTable<V>::Update(key, value);
+}
+
+template<class V>
+inline V LockBTreeTable<V>::Remove(const char *key) {
+  std::lock_guard<std::shared_mutex> lock(mutex_);
+  return BTreeTable<V>::Remove(key);
+}
+
+template<class V>
+inline std::size_t LockBTreeTable<V>::Size() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return BTreeTable<V>::Size();
+}
+
+template<class V>
+inline std::vector<typename LockBTreeTable<V>::KVPair>
+LockBTreeTable<V>::Entries(const char *key, size_t n) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return BTreeTable<V>::Entries(key, n);
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_LOCK_BTREE_TABLE_H_
@@ -12,15 +12,17 @@
 
 #include <unordered_map>
 #include <vector>
+#include "lib/epoch.h"
 #include "lib/string.h"
 
 namespace vmp {
 
-template <class V, class MA = MemAlloc,
-    class PA = std::allocator<std::pair<String, V>>>
+template <class V, class MA = MemAlloc, class H = WyHasher,
+    class PA = std::allocator<std::pair<const BasicString<H>, V>>>
 class StlHashtable : public StringHashtable<V> {
  public:
   typedef typename StringHashtable<V>::KVPair KVPair;
+  typedef BasicString<H> Key;
 
   StlHashtable(std::size_t num_buckets = 11, float max_load_factor = 2.0);
 
@@ -32,66 +34,100 @@ class StlHashtable : public StringHashtable<V> {
                               std::size_t n = -1) const;
   std::size_t Size() const { return table_.size(); }
 
+  ///
+  /// Variants for callers that already hold the key's length and hash,
+  /// e.g. from Key::Wrap(key, len) or Key::Wrap(key, len, hash).
+  ///
+  V Get(const Key &key) const;
+  bool Insert(const Key &key, V value);
+  V Update(const Key &key, V value);
+  V Remove(const Key &key);
+
  private:
   struct Hash {
-    uint64_t operator()(const String &hstr) const { return hstr.hash(); }
+    uint64_t operator()(const Key &hstr) const { return hstr.hash(); }
   };
 
   struct Equal {
-    bool operator()(const String &a, const String &b) const { return a == b; }
+    bool operator()(const Key &a, const Key &b) const { return a == b; }
   };
 
-  typedef std::unordered_map<String, V, Hash, Equal, PA> Hashtable;
+  typedef std::unordered_map<Key, V, Hash, Equal, PA> Hashtable;
   Hashtable table_;
 };
 
-template<class V, class MA, class PA>
-StlHashtable<V, MA, PA>::StlHashtable(std::size_t n, float f) : table_(n) {
+template<class V, class MA, class H, class PA>
+StlHashtable<V, MA, H, PA>::StlHashtable(std::size_t n, float f) : table_(n) {
   table_.max_load_factor(f);
 }
 
-template<class V, class MA, class PA>
-V StlHashtable<V, MA, PA>::Get(const char *key) const {
-  typename Hashtable::const_iterator pos = table_.find(String::Wrap(key));
+template<class V, class MA, class H, class PA>
+V StlHashtable<V, MA, H, PA>::Get(const char *key) const {
+  return Get(Key::Wrap(key));
+}
+
+template<class V, class MA, class H, class PA>
+bool StlHashtable<V, MA, H, PA>::Insert(const char *key, V value) {
+  if (!key) return false;
+  return Insert(Key::Wrap(key), value);
+}
+
+template<class V, class MA, class H, class PA>
+V StlHashtable<V, MA, H, PA>::Update(const char *key, V value) {
+  return Update(Key::Wrap(key), value);
+}
+
+template<class V, class MA, class H, class PA>
+V StlHashtable<V, MA, H, PA>::Remove(const char *key) {
+  return Remove(Key::Wrap(key));
+}
+
+template<class V, class MA, class H, class PA>
+V StlHashtable<V, MA, H, PA>::Get(const Key &key) const {
+  typename Hashtable::const_iterator pos = table_.find(key);
   if (pos == table_.end()) return NULL;
   else return pos->second;
 }
 
-template<class V, class MA, class PA>
-bool StlHashtable<V, MA, PA>::Insert(const char *key, V value) {
-  if (!key) return false;
-  String skey = String::Copy<MA>(key);
+template<class V, class MA, class H, class PA>
+bool StlHashtable<V, MA, H, PA>::Insert(const Key &key, V value) {
+  if (table_.count(key)) return false;
+  Key skey = Key::template Copy<MA>(key);
   return table_.insert(std::make_pair(skey, value)).second;
 }
 
-template<class V, class MA, class PA>
-V StlHashtable<V, MA, PA>::Update(const char *key, V value) {
-  typename Hashtable::iterator pos = table_.find(String::Wrap(key));
+template<class V, class MA, class H, class PA>
+V StlHashtable<V, MA, H, PA>::Update(const Key &key, V value) {
+  typename Hashtable::iterator pos = table_.find(key);
   if (pos == table_.end()) return NULL;
   V old = pos->second;
   pos->second = value;
   return old;
 }
 
-template<class V, class MA, class PA>
-V StlHashtable<V, MA, PA>::Remove(const char *key) {
-  typename Hashtable::const_iterator pos = table_.find(String::Wrap(key));
+template<class V, class MA, class H, class PA>
+V StlHashtable<V, MA, H, PA>::Remove(const Key &key) {
+  typename Hashtable::const_iterator pos = table_.find(key);
   if (pos == table_.end()) return NULL;
-  String::Free<MA>(pos->first);
+  // Keys returned by Entries() stay valid for readers inside an EpochGuard.
+  EpochManager::Global().Retire(const_cast<char *>(pos->first.value()),
+      pos->first.length() + 1, [](void *p, std::size_t size) {
+        MA::Free(static_cast<char *>(p), size);
+      });
   V old = pos->second;
   table_.erase(pos);
   return old;
 }
 
-template<class V, class MA, class PA>
-std::vector<typename StlHashtable<V, MA, PA>::KVPair>
-StlHashtable<V, MA, PA>::Entries(const char *key, std::size_t n) const {
+template<class V, class MA, class H, class PA>
+std::vector<typename StlHashtable<V, MA, H, PA>::KVPair>
+StlHashtable<V, MA, H, PA>::Entries(const char *key, std::size_t n) const {
   std::vector<KVPair> pairs;
   typename Hashtable::const_iterator pos;
   if (!key) {
     pos = table_.cbegin();
   } else {
-    pos = table_.find(String::Wrap(key));
+    pos = table_.find(Key::Wrap(key));
   }
   for (std::size_t i = 0; pos != table_.end() && i < n; ++pos, ++i) {
     pairs.push_back(std::make_pair(pos->first.value(), pos->second));
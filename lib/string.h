@@ -13,80 +13,115 @@
 #include <cassert>
 #include <cstdint>
 
+#include "lib/hash.h"
 #include "lib/mem_alloc.h"
 
 namespace vmp {
 
-class String {
+///
+/// A C string with its length and hash computed once. H selects the hash
+/// function (see lib/hash.h). Callers that already know the length, or the
+/// hash as well, can pass them in to skip the strlen and rehash.
+///
+template <class H>
+class BasicString {
  public:
-  String() : hash_(0), value_(NULL), len_(0) { }
+  typedef H Hasher;
+
+  BasicString() : hash_(0), value_(NULL), len_(0) { }
   uint64_t hash() const { return hash_; }
   const char *value() const { return value_; }
   size_t length() const { return len_; }
-  void set_value(const char *v);
+  void set_value(const char *v) { set_value(v, strlen(v)); }
+  void set_value(const char *v, size_t len) {
+    set_value(v, len, H::Hash(v, len));
+  }
+  void set_value(const char *v, size_t len, uint64_t hash);
 
   template <class Alloc>
-  static String Copy(const char *v);
+  static BasicString Copy(const char *v);
+  template <class Alloc>
+  static BasicString Copy(const BasicString &str); ///< Keeps len and hash
 
-  static String Wrap(const char *v);
+  static BasicString Wrap(const char *v);
+  static BasicString Wrap(const char *v, size_t len);
+  static BasicString Wrap(const char *v, size_t len, uint64_t hash);
 
   template <class Alloc>
-  static void Free(const String& str);
+  static void Free(const BasicString& str);
 
-  bool operator==(const String &other) const;
+  bool operator==(const BasicString &other) const;
 
  private:
-  uint64_t SDBMHash(const char *str);
-
   uint64_t hash_;
   const char *value_;
   size_t len_;
 };
 
-inline void String::set_value(const char *v) {
+typedef BasicString<WyHasher> String;
+
+template <class H>
+inline void BasicString<H>::set_value(const char *v, size_t len,
+                                      uint64_t hash) {
   value_ = v;
-  len_ = strlen(value_);
-  hash_ = SDBMHash(value_);
+  len_ = len;
+  hash_ = hash;
 }
 
-inline uint64_t String::SDBMHash(const char *cstr) {
-  uint64_t hash = 0;
-  uint64_t c;
-  while ((c = *cstr++) != '\0') {
-    hash = c + (hash << 6) + (hash << 16) - hash;
-  }
-  return hash;
+template <class H>
+template <class Alloc>
+inline BasicString<H> BasicString<H>::Copy(const char *cstr) {
+  assert(cstr);
+  return Copy<Alloc>(Wrap(cstr));
 }
 
+template <class H>
 template <class Alloc>
-inline String String::Copy(const char *cstr) {
-  assert(cstr);
-  String hstr;
-  const size_t len = strlen(cstr); 
-  char *str = (char *)Alloc::Malloc(len + 1);
-  hstr.set_value(strcpy(str, cstr));
-  assert(hstr.length() == len);
+inline BasicString<H> BasicString<H>::Copy(const BasicString &other) {
+  BasicString hstr;
+  char *str = (char *)Alloc::Malloc(other.length() + 1);
+  memcpy(str, other.value(), other.length() + 1);
+  hstr.set_value(str, other.length(), other.hash());
   return hstr;
 }
 
-inline String String::Wrap(const char *cstr) {
+template <class H>
+inline BasicString<H> BasicString<H>::Wrap(const char *cstr) {
   assert(cstr);
-  String hstr;
+  BasicString hstr;
   hstr.set_value(cstr);
   return hstr;
 }
 
+template <class H>
+inline BasicString<H> BasicString<H>::Wrap(const char *cstr, size_t len) {
+  assert(cstr && cstr[len] == '\0');
+  BasicString hstr;
+  hstr.set_value(cstr, len);
+  return hstr;
+}
+
+template <class H>
+inline BasicString<H> BasicString<H>::Wrap(const char *cstr, size_t len,
+                                           uint64_t hash) {
+  assert(cstr && cstr[len] == '\0');
+  BasicString hstr;
+  hstr.set_value(cstr, len, hash);
+  return hstr;
+}
+
+template <class H>
 template <class Alloc>
-inline void String::Free(const String& hstr) {
+inline void BasicString<H>::Free(const BasicString& hstr) {
   Alloc::Free(hstr.value(), hstr.length() + 1);
 }
 
-inline bool String::operator==(const String &other) const {
-  if (hash_ != other.hash()) return false;
-  return strcmp(value_, other.value()) == 0;
+template <class H>
+inline bool BasicString<H>::operator==(const BasicString &other) const {
+  if (hash_ != other.hash() || len_ != other.length()) return false;
+  return memcmp(value_, other.value(), len_) == 0;
 }
 
 } // vmp
 
 #endif // YCSB_C_LIB_HASH_STRING_H_
-
@@ -0,0 +1,291 @@
+//
+//  striped_hashtable.h
+//  YCSB-C
+//
+//  A concurrent chained hashtable split into independently locked stripes.
+//  Writers take the mutex of one stripe; Get() takes no lock at all.
+//  Keys and values it hands out stay valid while the caller holds an
+//  EpochGuard.
+//
+
+#ifndef YCSB_C_LIB_STRIPED_HASHTABLE_H_
+#define YCSB_C_LIB_STRIPED_HASHTABLE_H_
+
+#include "lib/string_hashtable.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "lib/epoch.h"
+#include "lib/mem_alloc.h"
+#include "lib/string.h"
+
+namespace vmp {
+
+///
+/// Readers traverse chains with acquire loads while writers publish with
+/// release stores. A resize relinks nodes into a new bucket array, so each
+/// stripe carries a sequence counter that is odd during a resize; readers
+/// retry if it changed under them. Unlinked nodes and old bucket arrays are
+/// retired through the global EpochManager, because a reader may still be
+/// walking them.
+///
+template <class V, class MA = MemAlloc>
+class StripedHashtable : public StringHashtable<V> {
+ public:
+  typedef typename StringHashtable<V>::KVPair KVPair;
+
+  StripedHashtable(std::size_t num_stripes = 64,
+                   std::size_t buckets_per_stripe = 16,
+                   float max_load_factor = 2.0);
+  ~StripedHashtable();
+
+  StripedHashtable(const StripedHashtable &) = delete;
+  StripedHashtable &operator=(const StripedHashtable &) = delete;
+
+  V Get(const char *key) const; ///< Returns NULL if the key is not found
+  bool Insert(const char *key, V value);
+  V Update(const char *key, V value);
+  V Remove(const char *key);
+  std::vector<KVPair> Entries(const char *key = NULL,
+                              std::size_t n = -1) const;
+  std::size_t Size() const;
+
+ private:
+  struct Node {
+    Node(const String &k, V v) : next(NULL), key(k), value(v) { }
+    std::atomic<Node *> next;
+    String key;
+    std::atomic<V> value;
+  };
+
+  struct Buckets {
+    std::size_t mask;
+    std::atomic<Node *> *heads;
+  };
+
+  struct alignas(64) Stripe {
+    std::mutex mutex;
+    std::atomic<uint64_t> seq{0};
+    std::atomic<Buckets *> buckets{NULL};
+    std::size_t count = 0;
+  };
+
+  static Buckets *NewBuckets(std::size_t n);
+  static void DeleteBuckets(Buckets *b);
+  static void DeleteNode(Node *node);
+
+  Stripe &StripeOf(uint64_t hash) const {
+    return stripes_[(hash * 0x9E3779B97F4A7C15ULL) >> stripe_shift_];
+  }
+  ///
+  /// Returns the node of key in b, or NULL. Safe without the stripe lock.
+  ///
+  static Node *Find(const Buckets *b, const String &key);
+  void Grow(Stripe &stripe);
+
+  mutable std::vector<Stripe> stripes_;
+  int stripe_shift_;
+  float max_load_factor_;
+};
+
+template <class V, class MA>
+StripedHashtable<V, MA>::StripedHashtable(std::size_t num_stripes,
+                                          std::size_t buckets_per_stripe,
+                                          float max_load_factor)
+    : max_load_factor_(max_load_factor) {
+  int bits = 0;
+  while ((std::size_t(1) << bits) < num_stripes) ++bits;
+  std::size_t n = 1;
+  while (n < buckets_per_stripe) n <<= 1;
+
+  stripes_ = std::vector<Stripe>(std::size_t(1) << bits);
+  stripe_shift_ = 64 - bits;
+  for (Stripe &stripe : stripes_) stripe.buckets = NewBuckets(n);
+}
+
+template <class V, class MA>
+StripedHashtable<V, MA>::~StripedHashtable() {
+  for (Stripe &stripe : stripes_) {
+    Buckets *b = stripe.buckets.load();
+    for (std::size_t i = 0; i <= b->mask; ++i) {
+      Node *node = b->heads[i].load();
+      while (node) {
+        Node *next = node->next.load();
+        DeleteNode(node);
+        node = next;
+      }
+    }
+    DeleteBuckets(b);
+  }
+}
+
+template <class V, class MA>
+void StripedHashtable<V, MA>::DeleteNode(Node *node) {
+  String::Free<MA>(node->key);
+  MA::Delete(node);
+}
+
+template <class V, class MA>
+typename StripedHashtable<V, MA>::Buckets *
+StripedHashtable<V, MA>::NewBuckets(std::size_t n) {
+  Buckets *b = MA::template New<Buckets>();
+  b->mask = n - 1;
+  b->heads = static_cast<std::atomic<Node *> *>(
+      MA::Malloc(n * sizeof(std::atomic<Node *>)));
+  for (std::size_t i = 0; i < n; ++i) {
+    new (&b->heads[i]) std::atomic<Node *>(NULL);
+  }
+  return b;
+}
+
+template <class V, class MA>
+void StripedHashtable<V, MA>::DeleteBuckets(Buckets *b) {
+  MA::Free(b->heads, (b->mask + 1) * sizeof(std::atomic<Node *>));
+  MA::Delete(b);
+}
+
+template <class V, class MA>
+inline typename StripedHashtable<V, MA>::Node *StripedHashtable<V, MA>::Find(
+    const Buckets *b, const String &key) {
+  Node *node = b->heads[key.hash() & b->mask].load(std::memory_order_acquire);
+  while (node && !(node->key == key)) {
+    node = node->next.load(std::memory_order_acquire);
+  }
+  return node;
+}
+
+template <class V, class MA>
+void StripedHashtable<V, MA>::Grow(Stripe &stripe) {
+  Buckets *old = stripe.buckets.load(std::memory_order_relaxed);
+  Buckets *b = NewBuckets((old->mask + 1) * 2);
+
+  stripe.seq.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (std::size_t i = 0; i <= old->mask; ++i) {
+    // Moved nodes only point at nodes moved before them, and unmoved nodes
+    // at unmoved ones, so a concurrent reader never loops.
+    Node *node = old->heads[i].load(std::memory_order_relaxed);
+    while (node) {
+      Node *next = node->next.load(std::memory_order_relaxed);
+      std::atomic<Node *> &head = b->heads[node->key.hash() & b->mask];
+      node->next.store(head.load(std::memory_order_relaxed),
+                       std::memory_order_release);
+      head.store(node, std::memory_order_relaxed);
+      node = next;
+    }
+  }
+  stripe.buckets.store(b, std::memory_order_release);
+  stripe.seq.fetch_add(1, std::memory_order_release);
+  EpochManager::Global().Retire(old, 0, [](void *p, std::size_t) {
+    DeleteBuckets(static_cast<Buckets *>(p));
+  });
+}
+
+template <class V, class MA>
+V StripedHashtable<V, MA>::Get(const char *key) const {
+  String skey = String::Wrap(key);
+  Stripe &stripe = StripeOf(skey.hash());
+  EpochGuard guard;
+  while (true) {
+    uint64_t seq = stripe.seq.load(std::memory_order_acquire);
+    if (seq & 1) continue;
+    Node *node = Find(stripe.buckets.load(std::memory_order_acquire), skey);
+    V value = node ? node->value.load(std::memory_order_acquire) : NULL;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // A hit is always valid; a miss may be due to a concurrent resize.
+    if (node || stripe.seq.load(std::memory_order_relaxed) == seq) {
+      return value;
+    }
+  }
+}
+
+template <class V, class MA>
+bool StripedHashtable<V, MA>::Insert(const char *key, V value) {
+  if (!key) return false;
+  String skey = String::Wrap(key);
+  Stripe &stripe = StripeOf(skey.hash());
+  std::lock_guard<std::mutex> lock(stripe.mutex);
+  Buckets *b = stripe.buckets.load(std::memory_order_relaxed);
+  if (Find(b, skey)) return false;
+
+  Node *node = MA::template New<Node>(String::Copy<MA>(skey), value);
+  std::atomic<Node *> &head = b->heads[skey.hash() & b->mask];
+  node->next.store(head.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+  head.store(node, std::memory_order_release);
+
+  if (++stripe.count > max_load_factor_ * (b->mask + 1)) Grow(stripe);
+  return true;
+}
+
+template <class V, class MA>
+V StripedHashtable<V, MA>::Update(const char *key, V value) {
+  String skey = String::Wrap(key);
+  Stripe &stripe = StripeOf(skey.hash());
+  std::lock_guard<std::mutex> lock(stripe.mutex);
+  Node *node = Find(stripe.buckets.load(std::memory_order_relaxed), skey);
+  if (!node) return NULL;
+  return node->value.exchange(value, std::memory_order_acq_rel);
+}
+
+template <class V, class MA>
+V StripedHashtable<V, MA>::Remove(const char *key) {
+  String skey = String::Wrap(key);
+  Stripe &stripe = StripeOf(skey.hash());
+  std::lock_guard<std::mutex> lock(stripe.mutex);
+  Buckets *b = stripe.buckets.load(std::memory_order_relaxed);
+  std::atomic<Node *> *link = &b->heads[skey.hash() & b->mask];
+  Node *node = link->load(std::memory_order_relaxed);
+  while (node && !(node->key == skey)) {
+    link = &node->next;
+    node = link->load(std::memory_order_relaxed);
+  }
+  if (!node) return NULL;
+  // The node keeps its next pointer so readers standing on it can go on.
+  link->store(node->next.load(std::memory_order_relaxed),
+              std::memory_order_release);
+  --stripe.count;
+  V old = node->value.load(std::memory_order_relaxed);
+  EpochManager::Global().Retire(node, 0, [](void *p, std::size_t) {
+    DeleteNode(static_cast<Node *>(p));
+  });
+  return old;
+}
+
+template <class V, class MA>
+std::vector<typename StripedHashtable<V, MA>::KVPair>
+StripedHashtable<V, MA>::Entries(const char *key, std::size_t n) const {
+  std::vector<KVPair> pairs;
+  bool found = (key == NULL);
+  String skey = key ? String::Wrap(key) : String();
+  for (Stripe &stripe : stripes_) {
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    Buckets *b = stripe.buckets.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i <= b->mask; ++i) {
+      Node *node = b->heads[i].load(std::memory_order_relaxed);
+      for (; node; node = node->next.load(std::memory_order_relaxed)) {
+        if (!found && !(found = (node->key == skey))) continue;
+        if (pairs.size() == n) return pairs;
+        pairs.push_back(std::make_pair(node->key.value(),
+            node->value.load(std::memory_order_relaxed)));
+      }
+    }
+  }
+  return pairs;
+}
+
+template <class V, class MA>
+std::size_t StripedHashtable<V, MA>::Size() const {
+  std::size_t size = 0;
+  for (Stripe &stripe : stripes_) {
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    size += stripe.count;
+  }
+  return size;
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_STRIPED_HASHTABLE_H_
@@ -0,0 +1,312 @@
+//
+//  swiss_hashtable.h
+//  YCSB-C
+//
+//  An open-addressing hashtable in the style of Abseil's Swiss tables.
+//  One control byte per slot holds 7 bits of the hash, and a group of 16
+//  control bytes is matched against a probe with a single SSE2 compare.
+//  Slots store the full hash, the length and, for short keys, the key bytes
+//  themselves, so a hit usually costs one control load and one slot line.
+//
+
+#ifndef YCSB_C_LIB_SWISS_HASHTABLE_H_
+#define YCSB_C_LIB_SWISS_HASHTABLE_H_
+
+#include "lib/string_hashtable.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "lib/mem_alloc.h"
+#include "lib/string.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace vmp {
+
+template <class V, class MA = MemAlloc>
+class SwissHashtable : public StringHashtable<V> {
+ public:
+  typedef typename StringHashtable<V>::KVPair KVPair;
+
+  SwissHashtable(std::size_t capacity = 16);
+  ~SwissHashtable();
+
+  SwissHashtable(const SwissHashtable &) = delete;
+  SwissHashtable &operator=(const SwissHashtable &) = delete;
+
+  V Get(const char *key) const; ///< Returns NULL if the key is not found
+  bool Insert(const char *key, V value);
+  V Update(const char *key, V value);
+  V Remove(const char *key);
+  std::vector<KVPair> Entries(const char *key = NULL,
+                              std::size_t n = -1) const;
+  std::size_t Size() const { return size_; }
+
+ private:
+  static const std::size_t kGroupWidth = 16;
+  static const std::size_t kInlineKeyBytes = 28; ///< Including the '\0'
+
+  static const int8_t kEmpty = -128;  // 0b10000000
+  static const int8_t kDeleted = -2;  // 0b11111110
+
+  ///
+  /// 48 bytes. Keys shorter than kInlineKeyBytes live in key_bytes; longer
+  /// ones are allocated through MA and their pointer is kept there instead.
+  ///
+  struct Slot {
+    uint64_t hash;
+    V value;
+    uint32_t len;
+    char key_bytes[kInlineKeyBytes];
+
+    bool is_inline() const { return len < kInlineKeyBytes; }
+    const char *key() const {
+      if (is_inline()) return key_bytes;
+      const char *p;
+      memcpy(&p, key_bytes, sizeof(p));
+      return p;
+    }
+  };
+
+  ///
+  /// A bit mask over one group of control bytes.
+  ///
+  struct Group {
+    explicit Group(const int8_t *ctrl) : ctrl_(ctrl) { }
+    uint32_t Match(int8_t h2) const;
+    uint32_t MatchEmpty() const { return Match(kEmpty); }
+    uint32_t MatchEmptyOrDeleted() const;
+    const int8_t *ctrl_;
+  };
+
+  static uint64_t Mix(uint64_t hash) { return hash * 0x9E3779B97F4A7C15ULL; }
+  static int8_t H2(uint64_t hash) { return Mix(hash) >> 57; }
+  std::size_t GroupOf(uint64_t hash) const {
+    return (Mix(hash) >> 7) & (num_groups_ - 1);
+  }
+
+  ///
+  /// Returns the slot index of the key, or -1.
+  ///
+  long Find(const String &key) const;
+  void Allocate(std::size_t capacity);
+  void Rehash(std::size_t capacity);
+  ///
+  /// Places a key known to be absent and returns its slot index.
+  ///
+  std::size_t Place(uint64_t hash);
+  void SetCtrl(std::size_t i, int8_t h) { ctrl_[i] = h; }
+  static bool IsFull(int8_t c) { return c >= 0; }
+
+  int8_t *ctrl_;
+  Slot *slots_;
+  std::size_t num_groups_;
+  std::size_t size_;
+  std::size_t growth_left_; ///< Empty slots usable before a rehash
+};
+
+#ifdef __SSE2__
+
+template <class V, class MA>
+inline uint32_t SwissHashtable<V, MA>::Group::Match(int8_t h2) const {
+  __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl_));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+}
+
+template <class V, class MA>
+inline uint32_t SwissHashtable<V, MA>::Group::MatchEmptyOrDeleted() const {
+  // Empty and deleted are the only control values with the sign bit set.
+  __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl_));
+  return _mm_movemask_epi8(ctrl);
+}
+
+#else
+
+template <class V, class MA>
+inline uint32_t SwissHashtable<V, MA>::Group::Match(int8_t h2) const {
+  uint32_t mask = 0;
+  for (std::size_t i = 0; i < kGroupWidth; ++i) {
+    if (ctrl_[i] == h2) mask |= 1u << i;
+  }
+  return mask;
+}
+
+template <class V, class MA>
+inline uint32_t SwissHashtable<V, MA>::Group::MatchEmptyOrDeleted() const {
+  uint32_t mask = 0;
+  for (std::size_t i = 0; i < kGroupWidth; ++i) {
+    if (ctrl_[i] < 0) mask |= 1u << i;
+  }
+  return mask;
+}
+
+#endif // __SSE2__
+
+template <class V, class MA>
+SwissHashtable<V, MA>::SwissHashtable(std::size_t capacity) : size_(0) {
+  std::size_t groups = 1;
+  while (groups * kGroupWidth * 7 / 8 < capacity) groups <<= 1;
+  Allocate(groups * kGroupWidth);
+}
+
+template <class V, class MA>
+SwissHashtable<V, MA>::~SwissHashtable() {
+  std::size_t capacity = num_groups_ * kGroupWidth;
+  for (std::size_t i = 0; i < capacity; ++i) {
+    if (IsFull(ctrl_[i]) && !slots_[i].is_inline()) {
+      MA::Free(slots_[i].key(), slots_[i].len + 1);
+    }
+  }
+  MA::Free(ctrl_, capacity);
+  MA::Free(slots_, capacity * sizeof(Slot));
+}
+
+template <class V, class MA>
+void SwissHashtable<V, MA>::Allocate(std::size_t capacity) {
+  num_groups_ = capacity / kGroupWidth;
+  ctrl_ = static_cast<int8_t *>(MA::Malloc(capacity));
+  memset(ctrl_, kEmpty, capacity);
+  slots_ = static_cast<Slot *>(MA::Malloc(capacity * sizeof(Slot)));
+  growth_left_ = capacity * 7 / 8;
+}
+
+template <class V, class MA>
+void SwissHashtable<V, MA>::Rehash(std::size_t capacity) {
+  int8_t *old_ctrl = ctrl_;
+  Slot *old_slots = slots_;
+  std::size_t old_capacity = num_groups_ * kGroupWidth;
+
+  Allocate(capacity);
+  for (std::size_t i = 0; i < old_capacity; ++i) {
+    if (!IsFull(old_ctrl[i])) continue;
+    // Slots are trivially relocatable: long keys move by pointer.
+    std::size_t pos = Place(old_slots[i].hash);
+    memcpy(&slots_[pos], &old_slots[i], sizeof(Slot));
+  }
+  MA::Free(old_ctrl, old_capacity);
+  MA::Free(old_slots, old_capacity * sizeof(Slot));
+}
+
+template <class V, class MA>
+std::size_t SwissHashtable<V, MA>::Place(uint64_t hash) {
+  std::size_t g = GroupOf(hash);
+  for (std::size_t step = 1; ; ++step) {
+    uint32_t mask = Group(ctrl_ + g * kGroupWidth).MatchEmptyOrDeleted();
+    if (mask) {
+      std::size_t pos = g * kGroupWidth + __builtin_ctz(mask);
+      if (ctrl_[pos] == kEmpty) --growth_left_;
+      SetCtrl(pos, H2(hash));
+      return pos;
+    }
+    g = (g + step) & (num_groups_ - 1);
+  }
+}
+
+template <class V, class MA>
+long SwissHashtable<V, MA>::Find(const String &key) const {
+  const uint64_t hash = key.hash();
+  const int8_t h2 = H2(hash);
+  std::size_t g = GroupOf(hash);
+  // Triangular probing over a power-of-two number of groups visits each
+  // group once.
+  for (std::size_t step = 1; step <= num_groups_; ++step) {
+    Group group(ctrl_ + g * kGroupWidth);
+    for (uint32_t mask = group.Match(h2); mask; mask &= mask - 1) {
+      std::size_t pos = g * kGroupWidth + __builtin_ctz(mask);
+      const Slot &slot = slots_[pos];
+      if (slot.hash == hash && slot.len == key.length() &&
+          memcmp(slot.key(), key.value(), slot.len) == 0) {
+        return pos;
+      }
+    }
+    if (group.MatchEmpty()) return -1;
+    g = (g + step) & (num_groups_ - 1);
+  }
+  return -1;
+}
+
+template <class V, class MA>
+V SwissHashtable<V, MA>::Get(const char *key) const {
+  long pos = Find(String::Wrap(key));
+  return pos < 0 ? NULL : slots_[pos].value;
+}
+
+template <class V, class MA>
+bool SwissHashtable<V, MA>::Insert(const char *key, V value) {
+  if (!key) return false;
+  String skey = String::Wrap(key);
+  if (Find(skey) >= 0) return false;
+
+  if (growth_left_ == 0) {
+    std::size_t capacity = num_groups_ * kGroupWidth;
+    // Reclaim tombstones in place unless the table is genuinely full.
+    Rehash(size_ * 2 < capacity * 7 / 8 ? capacity : capacity * 2);
+  }
+  Slot &slot = slots_[Place(skey.hash())];
+  slot.hash = skey.hash();
+  slot.value = value;
+  slot.len = skey.length();
+  if (slot.is_inline()) {
+    memcpy(slot.key_bytes, key, slot.len + 1);
+  } else {
+    char *copy = static_cast<char *>(MA::Malloc(slot.len + 1));
+    memcpy(copy, key, slot.len + 1);
+    memcpy(slot.key_bytes, &copy, sizeof(copy));
+  }
+  ++size_;
+  return true;
+}
+
+template <class V, class MA>
+V SwissHashtable<V, MA>::Update(const char *key, V value) {
+  long pos = Find(String::Wrap(key));
+  if (pos < 0) return NULL;
+  V old = slots_[pos].value;
+  slots_[pos].value = value;
+  return old;
+}
+
+template <class V, class MA>
+V SwissHashtable<V, MA>::Remove(const char *key) {
+  long pos = Find(String::Wrap(key));
+  if (pos < 0) return NULL;
+  Slot &slot = slots_[pos];
+  if (!slot.is_inline()) MA::Free(slot.key(), slot.len + 1);
+  // A group that still has an empty slot never made a probe continue past
+  // it, so the slot can become empty again instead of a tombstone.
+  std::size_t g = pos / kGroupWidth;
+  if (Group(ctrl_ + g * kGroupWidth).MatchEmpty()) {
+    SetCtrl(pos, kEmpty);
+    ++growth_left_;
+  } else {
+    SetCtrl(pos, kDeleted);
+  }
+  --size_;
+  return slot.value;
+}
+
+template <class V, class MA>
+std::vector<typename SwissHashtable<V, MA>::KVPair>
+SwissHashtable<V, MA>::Entries(const char *key, std::size_t n) const {
+  std::vector<KVPair> pairs;
+  std::size_t capacity = num_groups_ * kGroupWidth;
+  std::size_t pos = 0;
+  if (key) {
+    long found = Find(String::Wrap(key));
+    if (found < 0) return pairs;
+    pos = found;
+  }
+  for (; pos < capacity && pairs.size() < n; ++pos) {
+    if (IsFull(ctrl_[pos])) {
+      pairs.push_back(std::make_pair(slots_[pos].key(), slots_[pos].value));
+    }
+  }
+  return pairs;
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_SWISS_HASHTABLE_H_
@@ -1,30 +1,36 @@
-#/bin/bash
+#!/bin/bash
 
 repeat_num=3
+max_threads=${MAX_THREADS:-8}
 db_names=(
   "lock_stl"
-  "tbb_rand"
-  "tbb_scan"
+  "striped"
+  "btree"
 )
 
 trap 'kill $(jobs -p)' SIGINT
 
-if [ $# -ne 1 ]; then
-  echo "Usage: $0 [dir of workload specs]"
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 [dir of workload specs] [db names...]"
+  echo "Set WORKLOADS to pick specs (default: workload*.spec) and"
+  echo "MAX_THREADS to raise the thread sweep (default: 8)."
   exit 1
 fi
 
 workload_dir=$1
+shift
+if [ $# -gt 0 ]; then
+  db_names=("$@")
+fi
 
-for file_name in $workload_dir/workload*.spec; do
-  for ((tn=1; tn<=8; tn=tn*2)); do
+for file_name in $workload_dir/${WORKLOADS:-workload*.spec}; do
+  for ((tn=1; tn<=max_threads; tn=tn*2)); do
     for db_name in ${db_names[@]}; do
       for ((i=1; i<=repeat_num; ++i)); do
         echo "Running $db_name with $tn threads for $file_name"
-        ./ycsbc -db $db_name -threads $tn -P $file_name 2>>ycsbc.output &
+        ./ycsbc -- -db $db_name -threads $tn -P $file_name 2>>ycsbc.output &
         wait
       done
     done
   done
 done
-
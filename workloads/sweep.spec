@@ -0,0 +1,10 @@
+# Parameter sweep for ycsbc -sweep
+#   The records are loaded once with the -P properties, then every
+#   combination of the lists below runs in turn against the same DB.
+#   Workload files only need their transaction properties; paths are
+#   relative to the working directory.
+
+workloads=workloads/workloada.spec,workloads/workloadb.spec,workloads/workloadc.spec,workloads/workloadf.spec
+threads=1,2,4,8
+queuedepths=1,4
+repetitions=3
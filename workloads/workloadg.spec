@@ -21,3 +21,9 @@ multireadproportion=1.0
 requestdistribution=zipfian
 scanlengthdistribution=const
 
+
+# contiguous: a run of key numbers from one drawn key; independent: every key
+# of a batch drawn from requestdistribution. Batch sizes follow
+# multiread.maxbatch and multiread.batchdistribution (by default maxscanlength
+# and scanlengthdistribution).
+multiread.keyselection=contiguous
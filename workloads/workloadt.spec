@@ -0,0 +1,34 @@
+# Yahoo! Cloud System Benchmark
+# Workload T: Multi-key transactions
+#   Application example: Transfers between accounts
+#
+#   Read/update ratio: 50/50, as transactions reading 4 keys and updating 2
+#   Default data size: 1 KB records (10 fields, 100 bytes each, plus key)
+#   Request distribution: zipfian
+
+recordcount=10000000
+operationcount=10000000
+workload=com.yahoo.ycsb.workloads.CoreWorkload
+
+readallfields=true
+
+readproportion=0
+updateproportion=0
+scanproportion=0
+insertproportion=0
+transactionproportion=1.0
+
+requestdistribution=zipfian
+
+transaction.reads=4
+transaction.updates=2
+
+# Draw transaction.hotfraction of the keys uniformly from the first
+# transaction.hotset keys (0 for none); a smaller hot set conflicts more.
+transaction.hotset=0
+transaction.hotfraction=1
+
+# Conflicting transactions are retried with exponential backoff and jitter
+retry.conflict.attempts=10
+retry.conflict.backoff_us=50
+retry.conflict.max_backoff_us=5000
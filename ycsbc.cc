@@ -7,33 +7,227 @@
 //
 #include "ycsbc.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <functional>
 #include <future>
 #include <iostream>
+#include <sstream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "core/client.h"
+#include "core/connection.h"
 #include "core/core_workload.h"
+#include "core/histogram.h"
+#include "core/perf_counters.h"
+#include "core/reactor_stats.h"
+#include "core/retry_stats.h"
+#include "core/slow_ops.h"
 #include "core/timer.h"
+#include "core/txn_stats.h"
 #include "core/utils.h"
+#include "db/forwarding_db.h"
 
 #include <seastar/core/future.hh>
+#include <seastar/core/scheduling.hh>
+#include <seastar/core/gate.hh>
 #include <seastar/core/seastar.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/sleep.hh>
 #include <seastar/core/smp.hh>
 #include <seastar/core/thread.hh>
+#include <seastar/core/timer.hh>
+#include <seastar/net/api.hh>
 
 using namespace std;
 
 namespace ycsbc {
 void UsageMessage(const char *command);
 bool StrStartWith(const char *str, const char *pre);
-string ParseCommandLine(int argc, const char *argv[], utils::Properties &props);
+
+///
+/// Where a coordinator (-slaves) listens for its workers unless -port says.
+///
+const string kCoordinatorPortDefault = "7000";
+
+///
+/// Operations completed by one client, read by the StatusReporter.
+///
+struct alignas(64) Progress {
+  std::atomic<uint64_t> ops{0};
+  int group = -1;  ///< The shard the client runs on, if not i % groups
+};
+
+///
+/// While alive, prints every interval seconds the operations completed in
+/// the interval and so far, in total and per group (progress[i] counts
+/// towards its group, or group i % groups if unset), so that stalls show
+/// up as dips rather than vanish into the phase average. If set, sink is
+/// also handed the total.
+///
+class StatusReporter {
+ public:
+  StatusReporter(const string &phase, const vector<Progress> &progress,
+                 int groups, double interval,
+                 const string &group_name = "shards",
+                 std::function<void(uint64_t)> sink = nullptr)
+      : phase_(phase), progress_(progress), all_cpus_(groups),
+        group_name_(group_name), sink_(std::move(sink)),
+        last_ops_(0), last_time_(0) {
+    if (interval <= 0) return;
+    clock_.Start();
+    timer_.set_callback([this] { Report(); });
+    timer_.arm_periodic(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::duration<double>(interval)));
+  }
+  ~StatusReporter() { timer_.cancel(); }
+
+ private:
+  void Report();
+
+  const string phase_;
+  const vector<Progress> &progress_;
+  const int all_cpus_;
+  const string group_name_;
+  std::function<void(uint64_t)> sink_;
+  seastar::timer<> timer_;
+  utils::Timer<double> clock_;
+  uint64_t last_ops_;
+  double last_time_;
+};
+
+void StatusReporter::Report() {
+  double now = clock_.End();
+  vector<uint64_t> shard_ops(all_cpus_);
+  uint64_t ops = 0;
+  for (size_t i = 0; i < progress_.size(); ++i) {
+    uint64_t n = progress_[i].ops.load(std::memory_order_relaxed);
+    const int group = progress_[i].group;
+    shard_ops[group >= 0 ? group : i % all_cpus_] += n;
+    ops += n;
+  }
+  cerr << "[" << phase_ << "] " << now << " sec: " << ops << " operations; "
+       << (ops - last_ops_) / (now - last_time_) / 1000 << " KTPS; "
+       << group_name_ << ':';
+  for (int s = 0; s < all_cpus_; ++s) cerr << ' ' << s << ':' << shard_ops[s];
+  cerr << endl;
+  if (sink_) sink_(ops);
+  last_ops_ = ops;
+  last_time_ = now;
+}
+
+///
+/// What a phase measured, for comparing runs and for merging the results
+/// of several processes.
+///
+struct PhaseResult {
+  double ktps = 0;
+  double avg_ms = 0;
+  double p99_ms = 0;
+  double p999_ms = 0;
+  uint64_t ops = 0;
+  uint64_t oks = 0;
+  double seconds = 0;
+  utils::Histogram latency;
+};
+
+///
+/// Prints the latency percentiles of a phase and a histogram with one
+/// power-of-two bucket of microseconds per line. Stores the percentiles and
+/// a mergeable histogram in result.
+///
+void ReportLatency(const string &phase, vector<vector<double>> &latencies,
+                   PhaseResult &result) {
+  vector<double> total_latency;
+  for (vector<double> &latency : latencies) {
+    total_latency.insert(total_latency.end(), latency.begin(), latency.end());
+    for (double l : latency) result.latency.Add(l);
+  }
+  if (total_latency.empty()) return;
+  // Every operation has a latency, failed ones included
+  const size_t sum = total_latency.size();
+  size_t pos_99 = sum - sum / 100 - 1;
+  size_t pos_999 = sum - sum / 1000 - 1;
+
+  cout << "# " << phase << " latency (ms)" << endl;
+  double total = 0;
+  for (double l : total_latency) total += l;
+  result.avg_ms = total / total_latency.size() * 1000;
+  cout << "avg latency:\t" << result.avg_ms << endl;
+  nth_element(total_latency.begin(), total_latency.begin() + pos_99,
+              total_latency.end());
+  result.p99_ms = *(total_latency.begin() + pos_99) * 1000;
+  cout << "99% tail latency:\t" << result.p99_ms << endl;
+  nth_element(total_latency.begin(), total_latency.begin() + pos_999,
+              total_latency.end());
+  result.p999_ms = *(total_latency.begin() + pos_999) * 1000;
+  cout << "99.9% tail latency:\t" << result.p999_ms << endl;
+
+  vector<size_t> buckets;
+  for (double latency : total_latency) {
+    size_t b = 0;
+    while (b < 63 && latency * 1e6 >= double(uint64_t(1) << b)) ++b;
+    if (b >= buckets.size()) buckets.resize(b + 1);
+    ++buckets[b];
+  }
+  cout << "# " << phase << " latency histogram (us)" << endl;
+  for (size_t b = 0; b < buckets.size(); ++b) {
+    if (!buckets[b]) continue;
+    cout << "<" << (uint64_t(1) << b) << '\t' << buckets[b] << endl;
+  }
+}
+
+///
+/// The per-shard probes started just before and stopped just after the
+/// clients of each phase, so that they see the phase and nothing else.
+///
+struct Probes {
+  std::unique_ptr<utils::PerfCounters> perf;
+  std::unique_ptr<utils::ReactorStats> reactor;
+  std::unique_ptr<ycsbc::SlowOps> slow_ops;
+  std::unique_ptr<ycsbc::TxnStats> txn_stats;
+  std::unique_ptr<ycsbc::RetryStats> retry_stats;
+  ///
+  /// If set, handed the operations completed so far at every status
+  /// interval; a worker streams them to its coordinator.
+  ///
+  std::function<void(uint64_t)> progress_sink;
+
+  void Start() {
+    if (perf) perf->Start().get();
+    if (reactor) reactor->Start().get();
+  }
+
+  void Stop() {
+    if (reactor) reactor->Stop().get();
+    if (perf) perf->Stop().get();
+  }
+
+  void Report(const string &phase, uint64_t ops, const vector<int> &clients,
+              double seconds) const {
+    if (perf) perf->Report(phase, ops);
+    if (reactor) reactor->Report(phase, clients);
+    if (slow_ops) slow_ops->Report(phase);
+    txn_stats->Report(phase, seconds);
+    retry_stats->Report(phase);
+  }
+};
 
 int DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops,
-                   bool is_loading, vector<double> *latency, int id) {
+                   bool is_loading, vector<double> *latency, int id,
+                   Progress *progress, int queue_depth,
+                   const Probes *probes = nullptr) {
   db->Init();
-  ycsbc::Client client(*db, *wl);
+  ycsbc::Client client(*db, *wl,
+                       probes ? probes->txn_stats.get() : nullptr,
+                       probes ? probes->retry_stats.get() : nullptr);
+  ycsbc::SlowOps *slow_ops = probes ? probes->slow_ops.get() : nullptr;
   utils::Timer<double> timer_us;
   int current_ops;
 
@@ -43,21 +237,30 @@ int DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops,
   std::vector<utils::Timer<double>> timers;
   std::vector<int> zeros(num_ops, 0);
 
-  seastar::max_concurrent_for_each(zeros, 1, [&timers, is_loading, &client, latency, &oks, id](int) {
+  seastar::max_concurrent_for_each(zeros, queue_depth, [&timers, is_loading, &client, latency, &oks, id, progress, slow_ops](int) {
     utils::Timer<double> now;
     now.Start();
+    // Only filled in, at the cost of copying the key, if slow ops are kept
+    std::unique_ptr<ycsbc::OpRecord> record(
+        slow_ops ? new ycsbc::OpRecord : nullptr);
+    const auto start = slow_ops ? std::chrono::system_clock::now()
+                                : std::chrono::system_clock::time_point();
 
     seastar::future<bool> fut = seastar::make_ready_future<bool>(false);
 
     if (is_loading) {
-      fut = seastar::async([&client, id]() { return client.DoInsert(id).get(); });
+      fut = seastar::async([&client, id, r = record.get()]() { return client.DoInsert(id, r).get(); });
     } else {
-      fut = seastar::async([&client, id]() { return client.DoTransaction(id).get(); });
+      fut = seastar::async([&client, id, r = record.get()]() { return client.DoTransaction(id, r).get(); });
     }
 
-    return fut.then([now, latency, &oks](bool ok) mutable {
-      if (latency) latency->push_back(now.End());
+    return fut.then([now, latency, &oks, progress, slow_ops, start,
+                     record = std::move(record)](bool ok) mutable {
+      double elapsed = now.End();
+      if (latency) latency->push_back(elapsed);
+      if (slow_ops) slow_ops->Add(*record, start, elapsed);
       oks += ok;
+      progress->ops.fetch_add(1, std::memory_order_relaxed);
     });
   }).get();
 
@@ -92,12 +295,152 @@ int DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops,
   return oks;
 }
 
+///
+/// Issues num_ops transactions on a fixed schedule of rate per second,
+/// whether or not earlier ones have completed, up to max_outstanding at a
+/// time. Latency runs from when an operation was due, not from when it was
+/// sent, so that a slow engine cannot hide its queueing delay by holding
+/// the client back.
+///
+int OpenLoopClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops,
+                   vector<double> *latency, int id, Progress *progress,
+                   double rate, int max_outstanding,
+                   const Probes *probes = nullptr) {
+  typedef std::chrono::steady_clock Clock;
+  db->Init();
+  ycsbc::Client client(*db, *wl,
+                       probes ? probes->txn_stats.get() : nullptr,
+                       probes ? probes->retry_stats.get() : nullptr);
+  ycsbc::SlowOps *slow_ops = probes ? probes->slow_ops.get() : nullptr;
+  int oks = 0;
+  seastar::semaphore outstanding(max_outstanding);
+  seastar::gate running;
+  const Clock::time_point start = Clock::now();
+
+  for (int i = 0; i < num_ops; ++i) {
+    const Clock::time_point due = start +
+        std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(i / rate));
+    Clock::time_point now = Clock::now();
+    if (due > now) seastar::sleep(due - now).get();
+    outstanding.wait().get();
+    std::unique_ptr<ycsbc::OpRecord> record(
+        slow_ops ? new ycsbc::OpRecord : nullptr);
+    (void)seastar::with_gate(running, [&, due,
+                                       record = std::move(record)]() mutable {
+      ycsbc::OpRecord *r = record.get();
+      return seastar::async([&client, id, r] {
+        return client.DoTransaction(id, r).get();
+      }).then([&, due, record = std::move(record)](bool ok) {
+        const double elapsed =
+            std::chrono::duration<double>(Clock::now() - due).count();
+        latency->push_back(elapsed);
+        if (slow_ops) {
+          // When the operation was due, in wall-clock time
+          slow_ops->Add(*record,
+                        std::chrono::system_clock::now() -
+                            std::chrono::duration_cast<
+                                std::chrono::system_clock::duration>(
+                                Clock::now() - due),
+                        elapsed);
+        }
+        oks += ok;
+        progress->ops.fetch_add(1, std::memory_order_relaxed);
+      }).finally([&outstanding] { outstanding.signal(); });
+    });
+  }
+  running.close().get();
+  db->Close();
+  return oks;
+}
+
+///
+/// Feeds one shard's sorted slice of the load keys to DB::BulkLoad().
+///
+class WorkloadRun : public DB::RecordRun {
+ public:
+  WorkloadRun(CoreWorkload &wl, vector<string> keys, Progress *progress)
+      : workload_(wl), keys_(std::move(keys)), next_(0), progress_(progress) {}
+
+  bool Next(string &key, vector<DB::KVPair> &values) {
+    if (next_ == keys_.size()) return false;
+    key = std::move(keys_[next_++]);
+    workload_.BuildValues(values);
+    progress_->ops.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  size_t size() const { return keys_.size(); }
+
+ private:
+  CoreWorkload &workload_;
+  vector<string> keys_;
+  size_t next_;
+  Progress *progress_;
+};
+
+int DelegateBulkLoad(ycsbc::DB *db, ycsbc::CoreWorkload *wl, int part,
+                     int parts, Progress *progress) {
+  db->Init();
+  // Each shard generates and sorts its own slice, in parallel.
+  WorkloadRun run(*wl, wl->LoadKeys(part, parts), progress);
+  int loaded = db->BulkLoad(wl->NextTable(), run).get();
+  db->Close();
+  return loaded;
+}
+
 string ParseCommandLine(int argc, const char *argv[],
                         utils::Properties &props) {
   int argindex = 1;
   string filename;
   while (argindex < argc && StrStartWith(argv[argindex], "-")) {
-    if (strcmp(argv[argindex], "-threads") == 0) {
+    if (strcmp(argv[argindex], "-db") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("dbname", argv[argindex]);
+      argindex++;
+    } else if (strcmp(argv[argindex], "-sweep") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("sweep", argv[argindex]);
+      argindex++;
+    } else if (strcmp(argv[argindex], "-qd") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("queuedepth", argv[argindex]);
+      argindex++;
+    } else if (strcmp(argv[argindex], "-target") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("target", argv[argindex]);
+      argindex++;
+    } else if (strcmp(argv[argindex], "-tenants") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("tenants", argv[argindex]);
+      argindex++;
+    } else if (strcmp(argv[argindex], "-search") == 0) {
+      props.SetProperty("search", "true");
+      argindex++;
+    } else if (strcmp(argv[argindex], "-perf") == 0) {
+      props.SetProperty("perf", "true");
+      argindex++;
+    } else if (strcmp(argv[argindex], "-threads") == 0) {
       argindex++;
       if (argindex >= argc) {
         UsageMessage(argv[0]);
@@ -190,6 +533,31 @@ void UsageMessage(const char *command) {
   cout << "Usage: " << command << " [options]" << endl;
   cout << "Options:" << endl;
   cout << "  -threads n: execute using n threads (default: 1)" << endl;
+  cout << "  -qd n: keep n operations in flight per thread (default: 1)"
+       << endl;
+  cout << "  -target n: issue n operations per second in all, open-loop"
+       << endl;
+  cout << "  -search: load once, then search for the highest rate that meets"
+          " the search.* latency SLO"
+       << endl;
+  cout << "  -perf: report hardware counters per operation for each phase"
+       << endl;
+  cout << "  -sweep file: load once, then run every configuration listed in"
+          " file"
+       << endl;
+  cout << "  -tenants a.spec,b.spec: load once, then run the listed workloads"
+          " concurrently"
+       << endl;
+  cout << "  -slaves n: coordinate n worker processes instead of running"
+          " clients"
+       << endl;
+  cout << "  -host ip: run as a worker of the coordinator at ip" << endl;
+  cout << "  -port n: the coordinator's port (default: "
+       << kCoordinatorPortDefault << ")" << endl;
+  cout << "  -db dbname: specify the name of the DB to use (e.g., lock_stl,"
+          " striped, btree, log, null,"
+          " resp)"
+       << endl;
   cout << "  -P propertyfile: load properties from the given file. Multiple "
           "files can"
        << endl;
@@ -211,91 +579,930 @@ inline bool StrStartWith(const char *str, const char *pre) {
 void RunBench(int argc, const char *argv[], DB *db) {
   utils::Properties props;
   string file_name = ParseCommandLine(argc, argv, props);
-  vector<seastar::future<int>> actual_ops;
-  int total_ops = stoi(props[ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY]);
-  int sum = 0;
+  RunBench(props, file_name, db);
+}
 
-  ycsbc::CoreWorkload wl;
-  wl.Init(props);
+///
+/// Parses a list of shards such as "0-3,6".
+///
+vector<unsigned> ParseShards(const string &list) {
+  vector<unsigned> shards;
+  std::istringstream input(list);
+  string item;
+  while (std::getline(input, item, ',')) {
+    item = utils::Trim(item);
+    if (item.empty()) continue;
+    size_t dash = item.find('-');
+    unsigned first = stoul(item.substr(0, dash));
+    unsigned last = dash == string::npos ? first : stoul(item.substr(dash + 1));
+    for (unsigned shard = first; shard <= last; ++shard) {
+      if (shard >= seastar::smp::count) {
+        throw utils::Exception("No shard " + to_string(shard) + " in " + list +
+                               ": there are " +
+                               to_string(seastar::smp::count));
+      }
+      shards.push_back(shard);
+    }
+  }
+  if (shards.empty()) throw utils::Exception("Empty shard list: " + list);
+  return shards;
+}
 
-  const int num_threads = stoi(props.GetProperty("threadcount", "1"));
+///
+/// Where the clients of a phase run: client i on the (i mod n)th of the n
+/// client.shards (all shards by default). With client.per_shard set there
+/// are that many clients on each of them, whatever threadcount says.
+///
+struct Placement {
+  vector<unsigned> shards;
+  int num_clients = 0;
 
-  const bool init_data = stoi(props.GetProperty("init_data", "1"));
+  unsigned ShardOf(int client) const {
+    return shards[client % shards.size()];
+  }
 
-  vector<double> total_latency;
-  total_latency.reserve(total_ops);
-  vector<vector<double>> thread_latency(num_threads);
+  ///
+  /// How many clients each shard runs.
+  ///
+  vector<int> Clients() const {
+    vector<int> clients(seastar::smp::count);
+    for (int i = 0; i < num_clients; ++i) ++clients[ShardOf(i)];
+    return clients;
+  }
+};
 
-  int all_cpus = seastar::smp::all_cpus().size();
+Placement ClientPlacement(const utils::Properties &props) {
+  Placement placement;
+  const string shards = props.GetProperty("client.shards");
+  if (shards.empty()) {
+    for (unsigned s = 0; s < seastar::smp::count; ++s) {
+      placement.shards.push_back(s);
+    }
+  } else {
+    placement.shards = ParseShards(shards);
+  }
+  const int per_shard = stoi(props.GetProperty("client.per_shard", "0"));
+  placement.num_clients = per_shard > 0
+      ? per_shard * placement.shards.size()
+      : stoi(props.GetProperty("threadcount", "1"));
+  return placement;
+}
 
-  if (init_data) {  // Loads data
-    std::cout << "=============================== Load Data "
-                 "==============================="
-              << std::endl;
+///
+/// Sets threadcount to the number of clients client.per_shard asks for, so
+/// that CoreWorkload::Init() generates keys for every one of them.
+///
+void ApplyPlacement(utils::Properties &props) {
+  if (props.GetProperty("client.per_shard").empty()) return;
+  props.SetProperty("threadcount",
+                    to_string(ClientPlacement(props).num_clients));
+}
+
+///
+/// Opens the hardware counters if perf is set, the reactor statistics
+/// unless reactor.stats is false, and the slow operation capture if
+/// slowops.top or slowops.threshold_us is set. Multi-key transactions and
+/// retries are always counted.
+///
+Probes OpenProbes(const utils::Properties &props) {
+  Probes probes;
+  probes.txn_stats.reset(new ycsbc::TxnStats);
+  probes.retry_stats.reset(new ycsbc::RetryStats);
+  if (utils::StrToBool(props.GetProperty("perf", "false"))) {
+    probes.perf.reset(new utils::PerfCounters);
+    probes.perf->Open().get();
+  }
+  if (utils::StrToBool(props.GetProperty("reactor.stats", "true"))) {
+    probes.reactor.reset(new utils::ReactorStats(
+        stod(props.GetProperty("reactor.busy_threshold", "0.9")),
+        std::chrono::microseconds(
+            stoi(props.GetProperty("reactor.stall_period_us", "1000"))),
+        std::chrono::microseconds(
+            stoi(props.GetProperty("reactor.stall_threshold_us", "2000")))));
+  }
+  const size_t top = stoul(props.GetProperty("slowops.top", "0"));
+  const double threshold_us =
+      stod(props.GetProperty("slowops.threshold_us", "0"));
+  if (top > 0 || threshold_us > 0) {
+    probes.slow_ops.reset(new ycsbc::SlowOps(
+        top, threshold_us / 1e6,
+        stod(props.GetProperty("slowops.sample", "1")),
+        stoul(props.GetProperty("slowops.max_log", "100000")),
+        props.GetProperty("slowops.file")));
+  }
+  return probes;
+}
+
+///
+/// Loads insertcount records with threadcount clients (or one loader per
+/// shard with loadmode=bulk); the result's oks is how many were inserted.
+///
+PhaseResult LoadPhase(const utils::Properties &props,
+                      const string &file_name, DB *db, CoreWorkload &wl,
+                      Probes &probes) {
+  vector<seastar::future<int>> actual_ops;
+  const int total_ops = wl.insert_count();
+  const Placement placement = ClientPlacement(props);
+  const int num_threads = placement.num_clients;
+  const int queue_depth = stoi(props.GetProperty("queuedepth", "1"));
+  const int all_cpus = seastar::smp::all_cpus().size();
+  int sum = 0;
 
+  std::cout << "=============================== Load Data "
+               "==============================="
+            << std::endl;
+
+  vector<vector<double>> thread_latency(num_threads);
+  vector<Progress> progress(num_threads);
+  StatusReporter status("load", progress, all_cpus,
+                        stod(props.GetProperty("status.interval", "10")),
+                        "shards", probes.progress_sink);
+  const string load_mode = props.GetProperty("loadmode", "insert");
+  const int num_loaders = std::min(num_threads, all_cpus);
+  probes.Start();
+  utils::Timer<double> timer;
+  timer.Start();
+
+  if (load_mode == "bulk") {
+    for (int i = 0; i < num_loaders; ++i) {
+      progress[i].group = placement.ShardOf(i);
+      actual_ops.emplace_back(seastar::smp::submit_to(
+          placement.ShardOf(i),
+          [db, &wl, i, num_loaders, p = &progress[i]]() {
+            return seastar::async([db, &wl, i, num_loaders, p]() {
+              return DelegateBulkLoad(db, &wl, i, num_loaders, p);
+            });
+          }));
+    }
+  } else if (load_mode == "insert") {
     for (int i = 0; i < num_threads; ++i) {
+      progress[i].group = placement.ShardOf(i);
       actual_ops.emplace_back(seastar::smp::submit_to(
-          i % all_cpus, [db, &wl, ops = total_ops / num_threads, i]() {
-            return seastar::async([db, &wl, ops, i]() {
-              return DelegateClient(db, &wl, ops, true, nullptr, i);
+          placement.ShardOf(i), [db, &wl, ops = wl.NumSequenceKeys(i),
+                                 &thread_latency, i, p = &progress[i],
+                                 queue_depth, pr = &probes]() {
+            return seastar::async(
+                [db, &wl, ops, &thread_latency, i, p, queue_depth, pr]() {
+              return DelegateClient(db, &wl, ops, true, &thread_latency[i], i,
+                                    p, queue_depth, pr);
             });
           }));
     }
     assert((int)actual_ops.size() == num_threads);
+  } else {
+    throw utils::Exception("Unknown load mode: " + load_mode);
+  }
 
-    for (auto &n : actual_ops) {
-      sum += n.get();
-    }
-    cerr << "# Loading records:\t" << sum << endl;
+  for (auto &n : actual_ops) {
+    sum += n.get();
   }
+  double duration = timer.End();
+  probes.Stop();
+  cerr << "# Loading records:\t" << sum << endl;
+
+  PhaseResult result;
+  result.ktps = total_ops / duration / 1000;
+  result.ops = total_ops;
+  result.oks = sum;
+  result.seconds = duration;
+  cout << "# Load throughput (KTPS)" << endl;
+  cout << file_name << '\t' << num_threads << '\t';
+  cout << result.ktps << endl;
+  vector<int> clients = placement.Clients();
+  if (load_mode == "bulk") {
+    clients.assign(all_cpus, 0);
+    for (int i = 0; i < num_loaders; ++i) ++clients[placement.ShardOf(i)];
+  }
+  probes.Report("Load", total_ops, clients, duration);
+  wl.ReportFieldLengths(cout);
+  ReportLatency("Load", thread_latency, result);
+  return result;
+}
+
+///
+/// Runs operationcount operations with threadcount clients, each keeping
+/// queuedepth operations in flight or, if target is set, issuing its share
+/// of target operations per second open-loop with at most
+/// openloop.max_outstanding in flight. The phase is named in the output,
+/// so that a warm-up run reads apart from the measured one.
+///
+PhaseResult TransactionPhase(const utils::Properties &props,
+                             const string &file_name, DB *db,
+                             CoreWorkload &wl, Probes &probes,
+                             const string &phase = "Transaction") {
+  vector<seastar::future<int>> actual_ops;
+  const int total_ops = stoi(props[CoreWorkload::OPERATION_COUNT_PROPERTY]);
+  const Placement placement = ClientPlacement(props);
+  const int num_threads = placement.num_clients;
+  const int queue_depth = stoi(props.GetProperty("queuedepth", "1"));
+  const double target = stod(props.GetProperty("target", "0"));
+  const int max_outstanding =
+      stoi(props.GetProperty("openloop.max_outstanding", "1024"));
+  const int all_cpus = seastar::smp::all_cpus().size();
+  int sum = 0;
 
   // Peforms transactions
-  std::cout << "=============================== Perform Transanction "
-               "==============================="
-            << std::endl;
-  actual_ops.clear();
-  total_ops = stoi(props[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
+  if (phase == "Transaction") {
+    std::cout << "=============================== Perform Transanction "
+                 "==============================="
+              << std::endl;
+  } else {
+    std::cout << "=============================== " << phase
+              << " ===============================" << std::endl;
+  }
+  vector<vector<double>> thread_latency(num_threads);
+  vector<Progress> progress(num_threads);
+  StatusReporter status(phase == "Transaction" ? "run" : phase, progress,
+                        all_cpus,
+                        stod(props.GetProperty("status.interval", "10")),
+                        "shards", probes.progress_sink);
+  probes.Start();
   utils::Timer<double> timer;
   timer.Start();
   for (int i = 0; i < num_threads; ++i) {
+    progress[i].group = placement.ShardOf(i);
     actual_ops.emplace_back(seastar::smp::submit_to(
-        i % all_cpus, [db, &wl, ops = total_ops / num_threads, &thread_latency, i]() {
-          return seastar::async([db, &wl, ops, &thread_latency, i]() {
-            return DelegateClient(db, &wl, ops, false, &thread_latency[i], i);
+        placement.ShardOf(i),
+        [db, &wl, ops = utils::ShareOf(total_ops, num_threads, i),
+         &thread_latency, i, p = &progress[i], queue_depth,
+         rate = target / num_threads, max_outstanding, pr = &probes]() {
+          return seastar::async([db, &wl, ops, &thread_latency, i, p,
+                                 queue_depth, rate, max_outstanding, pr]() {
+            if (rate > 0) {
+              return OpenLoopClient(db, &wl, ops, &thread_latency[i], i, p,
+                                    rate, max_outstanding, pr);
+            }
+            return DelegateClient(db, &wl, ops, false, &thread_latency[i], i,
+                                  p, queue_depth, pr);
           });
         }));
   }
   assert((int)actual_ops.size() == num_threads);
 
-  sum = 0;
   for (auto &n : actual_ops) {
     sum += n.get();
   }
   double duration = timer.End();
+  probes.Stop();
+
+  PhaseResult result;
+  result.ktps = total_ops / duration / 1000;
+  result.ops = total_ops;
+  result.oks = sum;
+  result.seconds = duration;
+  cout << "# " << phase << " throughput (KTPS)" << endl;
+  cout << file_name << '\t' << num_threads << '\t';
+  cout << result.ktps << endl;
+  probes.Report(phase, total_ops, placement.Clients(), duration);
+  wl.ReportFieldLengths(cout);
+
+  ReportLatency(phase, thread_latency, result);
+  return result;
+}
 
-  for (int t = 0; t < num_threads; t++) {
-    total_latency.insert(total_latency.end(), thread_latency[t].begin(),
-                         thread_latency[t].end());
+///
+/// Runs warmupcount operations (if any) as a phase of their own, so that
+/// caches, allocators and the engine settle before the measured run.
+///
+PhaseResult WarmUp(const utils::Properties &props, const string &file_name,
+                   DB *db, CoreWorkload &wl, Probes &probes) {
+  const string count = props.GetProperty("warmupcount", "0");
+  if (stoi(count) <= 0) return PhaseResult();
+  utils::Properties warm_props = props;
+  warm_props.SetProperty(CoreWorkload::OPERATION_COUNT_PROPERTY, count);
+  return TransactionPhase(warm_props, file_name, db, wl, probes, "Warm-up");
+}
+
+vector<string> SplitList(const string &list) {
+  vector<string> items;
+  size_t begin = 0;
+  while (begin <= list.size()) {
+    size_t end = list.find(',', begin);
+    if (end == string::npos) end = list.size();
+    string item = utils::Trim(list.substr(begin, end - begin));
+    if (!item.empty()) items.push_back(item);
+    begin = end + 1;
   }
-  size_t pos_avg = sum >> 2;
-  size_t pos_99 = sum - sum / 100 - 1;
-  size_t pos_999 = sum - sum / 1000 - 1;
+  return items;
+}
 
-  cout << "# Transaction throughput (KTPS)" << endl;
-  cout << file_name << '\t' << num_threads << '\t';
-  cout << total_ops / duration / 1000 << endl;
+///
+/// Returns the median, minimum and maximum of values.
+///
+std::tuple<double, double, double> Spread(vector<double> values) {
+  std::sort(values.begin(), values.end());
+  size_t n = values.size();
+  double median = n % 2 ? values[n / 2]
+                        : (values[n / 2 - 1] + values[n / 2]) / 2;
+  return std::make_tuple(median, values.front(), values.back());
+}
 
-  cout << "# Transaction latency (ms)" << endl;
-  nth_element(total_latency.begin(), total_latency.begin() + pos_avg,
-              total_latency.end());
-  cout << "avg latency:\t" << *(total_latency.begin() + pos_avg) * 1000 << endl;
-  nth_element(total_latency.begin(), total_latency.begin() + pos_99,
-              total_latency.end());
-  cout << "99% tail latency:\t" << *(total_latency.begin() + pos_99) * 1000
+///
+/// Loads the records once with props, then runs every combination of the
+/// sweep file's workloads, threads and queuedepths (comma-separated lists,
+/// defaulting to the command line's) repetitions times against the same
+/// DB, and prints one row per combination. A workload file only needs the
+/// transaction properties; the records stay as loaded, and so do the
+/// changes each run makes to them.
+///
+void RunSweep(const utils::Properties &props, const string &file_name,
+              DB *db) {
+  utils::Properties sweep;
+  ifstream input(props["sweep"]);
+  sweep.Load(input);
+  const vector<string> workloads =
+      SplitList(sweep.GetProperty("workloads", file_name));
+  const vector<string> threads =
+      SplitList(sweep.GetProperty("threads",
+                                  props.GetProperty("threadcount", "1")));
+  const vector<string> depths =
+      SplitList(sweep.GetProperty("queuedepths",
+                                  props.GetProperty("queuedepth", "1")));
+  const int repetitions = stoi(sweep.GetProperty("repetitions", "1"));
+  Probes probes = OpenProbes(props);
+
+  if (stoi(props.GetProperty("init_data", "1"))) {
+    CoreWorkload wl;
+    wl.Init(props);
+    LoadPhase(props, file_name, db, wl, probes);
+  }
+
+  struct Row {
+    string workload, threads, depth;
+    vector<double> ktps, p99_ms;
+  };
+  vector<Row> rows;
+  for (const string &workload : workloads) {
+    for (const string &thread_count : threads) {
+      for (const string &depth : depths) {
+        Row row = {workload, thread_count, depth, {}, {}};
+        utils::Properties run_props = props;
+        ifstream workload_input(workload);
+        run_props.Load(workload_input);
+        run_props.SetProperty("threadcount", thread_count);
+        run_props.SetProperty("queuedepth", depth);
+        ApplyPlacement(run_props);
+        // Keys are generated once per combination, not per run
+        CoreWorkload wl;
+        wl.Init(run_props);
+        WarmUp(run_props, workload, db, wl, probes);
+        for (int r = 0; r < repetitions; ++r) {
+          cerr << "# Sweep: " << workload << ", " << thread_count
+               << " threads, queue depth " << depth << ", repetition "
+               << r + 1 << "/" << repetitions << endl;
+          wl.ResetKeyCursors();
+          PhaseResult result =
+              TransactionPhase(run_props, workload, db, wl, probes);
+          row.ktps.push_back(result.ktps);
+          row.p99_ms.push_back(result.p99_ms);
+        }
+        rows.push_back(row);
+      }
+    }
+  }
+
+  cout << "# Sweep results (median, min, max over " << repetitions
+       << " repetitions)" << endl;
+  cout << "workload\tthreads\tqueuedepth\tKTPS\tKTPS min\tKTPS max"
+          "\tp99 ms\tp99 ms min\tp99 ms max"
        << endl;
-  nth_element(total_latency.begin(), total_latency.begin() + pos_999,
-              total_latency.end());
-  cout << "99.9% tail latency:\t" << *(total_latency.begin() + pos_999) * 1000
+  for (const Row &row : rows) {
+    auto [ktps, ktps_min, ktps_max] = Spread(row.ktps);
+    auto [p99, p99_min, p99_max] = Spread(row.p99_ms);
+    cout << row.workload << '\t' << row.threads << '\t' << row.depth << '\t'
+         << ktps << '\t' << ktps_min << '\t' << ktps_max << '\t' << p99
+         << '\t' << p99_min << '\t' << p99_max << endl;
+  }
+}
+
+//
+// Distributed runs. A coordinator (-slaves n) waits for n workers (-host,
+// -port) and talks to each over one TCP connection, a line per message:
+//
+//   coordinator               worker
+//   worker <w> <n>      -->
+//   file <name>         -->
+//   prop <key>=<value>  -->   (one per property)
+//   end                 -->
+//   phase <name>        -->
+//                       <--   ready <name>      (barrier: all workers ready)
+//   start <name>        -->
+//                       <--   progress <ops>    (every status.interval)
+//                       <--   done <ops> <oks> <seconds>
+//                       <--   latency <serialized utils::Histogram>
+//   ... further phases ...
+//   bye                 -->
+//
+
+///
+/// Properties of the coordinator's own, not handed to the workers.
+///
+bool IsLocalProperty(const string &key) {
+  return key == "slaves" || key == "host" || key == "port" ||
+         key == "dbname";
+}
+
+///
+/// Gives worker w of n its own range of the records to load.
+///
+void AssignKeyRange(utils::Properties &props, int w, int n) {
+  const int records = stoi(props[CoreWorkload::RECORD_COUNT_PROPERTY]);
+  uint64_t start = stoull(props.GetProperty(
+      CoreWorkload::INSERT_START_PROPERTY, CoreWorkload::INSERT_START_DEFAULT));
+  for (int i = 0; i < w; ++i) start += utils::ShareOf(records, n, i);
+  props.SetProperty(CoreWorkload::INSERT_START_PROPERTY, to_string(start));
+  props.SetProperty(CoreWorkload::INSERT_COUNT_PROPERTY,
+                    to_string(utils::ShareOf(records, n, w)));
+}
+
+///
+/// The name a phase goes by in the output.
+///
+string PhaseLabel(const string &phase) {
+  if (phase == "load") return "Load";
+  if (phase == "warmup") return "Warm-up";
+  return "Transaction";
+}
+
+///
+/// Runs the phases the coordinator starts, each at the same time as the
+/// other workers, with the coordinator's properties and this process's DB.
+///
+void RunWorker(const utils::Properties &local_props, DB *db) {
+  utils::Connection coordinator = utils::Connection::Connect(
+      local_props["host"],
+      stoi(local_props.GetProperty("port", kCoordinatorPortDefault)));
+
+  int w, n;
+  std::istringstream hello(coordinator.Receive().get());
+  string tag;
+  if (!(hello >> tag >> w >> n) || tag != "worker") {
+    throw utils::Exception("Unexpected greeting: " + hello.str());
+  }
+  utils::Properties props;
+  string file_name;
+  for (string line; (line = coordinator.Receive().get()) != "end";) {
+    if (StrStartWith(line.c_str(), "file ")) {
+      file_name = line.substr(5);
+    } else if (StrStartWith(line.c_str(), "prop ")) {
+      size_t eq = line.find('=');
+      props.SetProperty(line.substr(5, eq - 5), line.substr(eq + 1));
+    }
+  }
+  cerr << "# Worker " << w << " of " << n << ": records from "
+       << props[CoreWorkload::INSERT_START_PROPERTY] << ", "
+       << props[CoreWorkload::INSERT_COUNT_PROPERTY] << " to load" << endl;
+
+  ApplyPlacement(props);
+  CoreWorkload wl;
+  wl.Init(props);
+  Probes probes = OpenProbes(props);
+  probes.progress_sink = [&coordinator](uint64_t ops) {
+    coordinator.Send("progress " + to_string(ops));
+  };
+
+  for (string line; (line = coordinator.Receive().get()) != "bye";) {
+    if (!StrStartWith(line.c_str(), "phase ")) {
+      throw utils::Exception("Unexpected message: " + line);
+    }
+    const string phase = line.substr(6);
+    coordinator.Send("ready " + phase);
+    coordinator.Drain().get();
+    coordinator.Expect("start " + phase).get();
+
+    PhaseResult result;
+    if (phase == "load") {
+      result = LoadPhase(props, file_name, db, wl, probes);
+    } else if (phase == "warmup") {
+      result = WarmUp(props, file_name, db, wl, probes);
+    } else {
+      result = TransactionPhase(props, file_name, db, wl, probes);
+    }
+    coordinator.Send("done " + to_string(result.ops) + " " +
+                     to_string(result.oks) + " " +
+                     to_string(result.seconds));
+    coordinator.Send("latency " + result.latency.Serialize());
+    coordinator.Drain().get();
+  }
+  coordinator.Close().get();
+}
+
+///
+/// Accepts slaves workers, hands each the properties and its key range,
+/// starts every phase on all of them at once and prints the merged
+/// throughput and latency.
+///
+void RunCoordinator(const utils::Properties &props, const string &file_name) {
+  const int num_workers = stoi(props["slaves"]);
+  const uint16_t port =
+      stoi(props.GetProperty("port", kCoordinatorPortDefault));
+  seastar::listen_options options;
+  options.reuse_address = true;
+  seastar::server_socket server =
+      seastar::listen(seastar::make_ipv4_address(seastar::ipv4_addr(port)),
+                      options);
+
+  cerr << "# Waiting for " << num_workers << " workers on port " << port
        << endl;
+  vector<std::unique_ptr<utils::Connection>> workers;
+  while ((int)workers.size() < num_workers) {
+    seastar::accept_result accepted = server.accept().get();
+    workers.emplace_back(new utils::Connection(
+        std::move(accepted.connection)));
+    cerr << "# Worker " << workers.size() - 1 << " connected" << endl;
+  }
+
+  for (int w = 0; w < num_workers; ++w) {
+    utils::Properties worker_props = props;
+    AssignKeyRange(worker_props, w, num_workers);
+    workers[w]->Send("worker " + to_string(w) + " " + to_string(num_workers));
+    workers[w]->Send("file " + file_name);
+    for (const auto &prop : worker_props.properties()) {
+      if (IsLocalProperty(prop.first)) continue;
+      workers[w]->Send("prop " + prop.first + "=" + prop.second);
+    }
+    workers[w]->Send("end");
+  }
+
+  vector<string> phases;
+  if (stoi(props.GetProperty("init_data", "1"))) phases.push_back("load");
+  if (stoi(props.GetProperty("warmupcount", "0")) > 0) {
+    phases.push_back("warmup");
+  }
+  phases.push_back("run");
+
+  vector<int> ids(num_workers);
+  for (int w = 0; w < num_workers; ++w) ids[w] = w;
+  for (const string &phase : phases) {
+    for (auto &worker : workers) worker->Send("phase " + phase);
+    for (auto &worker : workers) {
+      worker->Drain().get();
+      worker->Expect("ready " + phase).get();
+    }
+
+    vector<Progress> progress(num_workers);
+    vector<PhaseResult> results(num_workers);
+    StatusReporter status(phase, progress, num_workers,
+                          stod(props.GetProperty("status.interval", "10")),
+                          "workers");
+    utils::Timer<double> timer;
+    for (auto &worker : workers) worker->Send("start " + phase);
+    timer.Start();
+    seastar::parallel_for_each(ids, [&](int w) {
+      return seastar::async([&, w] {
+        utils::Connection &worker = *workers[w];
+        worker.Drain().get();
+        while (true) {
+          std::istringstream message(worker.Receive().get());
+          string tag;
+          message >> tag;
+          if (tag == "progress") {
+            uint64_t ops;
+            message >> ops;
+            progress[w].ops.store(ops, std::memory_order_relaxed);
+          } else if (tag == "done") {
+            message >> results[w].ops >> results[w].oks >> results[w].seconds;
+            string latency = worker.Receive().get();
+            if (!StrStartWith(latency.c_str(), "latency ")) {
+              throw utils::Exception("Expected latency, got " + latency);
+            }
+            results[w].latency = utils::Histogram::Parse(latency.substr(8));
+            return;
+          } else {
+            throw utils::Exception("Unexpected message: " + message.str());
+          }
+        }
+      });
+    }).get();
+    double duration = timer.End();
+
+    PhaseResult total;
+    for (const PhaseResult &result : results) {
+      total.ops += result.ops;
+      total.oks += result.oks;
+      total.latency.Merge(result.latency);
+    }
+    const string label = PhaseLabel(phase);
+    cout << "# Global " << label << " throughput (KTPS)" << endl;
+    cout << file_name << '\t' << num_workers << " workers\t"
+         << total.ops / duration / 1000 << endl;
+    cout << "# Global " << label << " operations:\t" << total.ops
+         << "\tfailed:\t" << total.ops - total.oks << endl;
+    if (!total.latency.count()) continue;
+    cout << "# Global " << label << " latency (ms)" << endl;
+    cout << "mean latency:\t" << total.latency.Mean() * 1000 << endl;
+    cout << "50% latency:\t" << total.latency.Percentile(0.5) * 1000 << endl;
+    cout << "99% tail latency:\t" << total.latency.Percentile(0.99) * 1000
+         << endl;
+    cout << "99.9% tail latency:\t"
+         << total.latency.Percentile(0.999) * 1000 << endl;
+    cout << "max latency:\t" << total.latency.Max() * 1000 << endl;
+  }
+
+  for (auto &worker : workers) {
+    worker->Send("bye");
+    worker->Close().get();
+  }
+}
+
+///
+/// Loads the records once, then searches for the highest open-loop rate the
+/// DB sustains: search.percentile of the latency within search.slo_ms and
+/// at least search.min_achieved of the offered rate actually achieved. The
+/// range runs from search.min_rate to search.max_rate, or to the rate of a
+/// closed-loop run if that is not set, and is bisected search.steps times,
+/// each step running for about search.step_seconds. Every step is a phase
+/// of its own with its latency histogram; a table of the steps and the knee
+/// (the highest passing rate) follow.
+///
+void RunSearch(const utils::Properties &props, const string &file_name,
+               DB *db) {
+  const double slo_ms = stod(props.GetProperty("search.slo_ms", "1"));
+  const double percentile =
+      stod(props.GetProperty("search.percentile", "99"));
+  const double min_achieved =
+      stod(props.GetProperty("search.min_achieved", "0.95"));
+  const double step_seconds =
+      stod(props.GetProperty("search.step_seconds", "10"));
+  const int steps = stoi(props.GetProperty("search.steps", "8"));
+  double low = stod(props.GetProperty("search.min_rate", "0"));
+  double high = stod(props.GetProperty("search.max_rate", "0"));
+  Probes probes = OpenProbes(props);
+
+  // Keys are generated once; each phase below only sets its own target
+  // and operation count.
+  CoreWorkload wl;
+  wl.Init(props);
+  if (stoi(props.GetProperty("init_data", "1"))) {
+    LoadPhase(props, file_name, db, wl, probes);
+  }
+  WarmUp(props, file_name, db, wl, probes);
+  if (high <= 0) {
+    utils::Properties closed_props = props;
+    closed_props.SetProperty("target", "0");
+    wl.ResetKeyCursors();
+    high = TransactionPhase(closed_props, file_name, db, wl, probes,
+                            "Closed-loop").ktps * 1000;
+  }
+  if (high <= low) {
+    throw utils::Exception("search: max rate " + to_string(high) +
+                           " is not above min rate " + to_string(low));
+  }
+
+  struct Step {
+    double offered, achieved, latency_ms;
+    bool pass;
+  };
+  vector<Step> rows;
+  double knee = 0;
+  for (int i = 0; i < steps; ++i) {
+    const double rate = (low + high) / 2;
+    const uint64_t ops = std::max<uint64_t>(1, rate * step_seconds);
+    utils::Properties step_props = props;
+    step_props.SetProperty("target", to_string(rate));
+    step_props.SetProperty(CoreWorkload::OPERATION_COUNT_PROPERTY,
+                           to_string(ops));
+    cerr << "# Search: step " << i + 1 << "/" << steps << ", " << rate
+         << " ops/s" << endl;
+    wl.ResetKeyCursors();
+    PhaseResult result =
+        TransactionPhase(step_props, file_name, db, wl, probes,
+                         "Search step " + to_string(i + 1));
+    Step row;
+    row.offered = rate;
+    row.achieved = result.ops / result.seconds;
+    row.latency_ms = result.latency.Percentile(percentile / 100) * 1000;
+    row.pass = row.latency_ms <= slo_ms &&
+               row.achieved >= min_achieved * row.offered;
+    rows.push_back(row);
+    if (row.pass) {
+      knee = std::max(knee, rate);
+      low = rate;
+    } else {
+      high = rate;
+    }
+  }
+
+  cout << "# Search results (SLO: p" << percentile << " <= " << slo_ms
+       << " ms, achieved >= " << min_achieved << " of offered)" << endl;
+  cout << "step	offered ops/s	achieved ops/s	p" << percentile
+       << " ms	result" << endl;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    const Step &row = rows[i];
+    cout << i + 1 << '\t' << row.offered << '\t' << row.achieved << '\t'
+         << row.latency_ms << '\t' << (row.pass ? "pass" : "fail") << endl;
+  }
+  cout << "# Knee (ops/s)" << endl;
+  if (knee > 0) {
+    cout << file_name << '\t' << knee << endl;
+  } else {
+    cout << file_name << "\tnone: every step missed the SLO" << endl;
+  }
+}
+
+///
+/// One of the workloads that RunTenants runs side by side: its properties,
+/// its clients and what they measured.
+///
+struct Tenant {
+  string name;
+  utils::Properties props;
+  CoreWorkload wl;
+  Placement placement;
+  int num_threads = 0;
+  int total_ops = 0;
+  int queue_depth = 1;
+  double target = 0;
+  int max_outstanding = 0;
+  std::optional<seastar::scheduling_group> group;
+  vector<vector<double>> latency;
+  vector<Progress> progress;
+  int oks = 0;
+  double seconds = 0;
+};
+
+///
+/// Loads the records once with props, then runs the transactions of every
+/// workload file in tenants at the same time, each with the threadcount,
+/// queuedepth, target and operationcount of its own file. A tenant with
+/// tenant.shares set runs in a scheduling group of its own with that many
+/// shares, so the reactor divides CPU between busy tenants in proportion;
+/// the others share the default group. Every tenant reports its throughput
+/// and latency separately, followed by a table of all of them.
+///
+void RunTenants(const utils::Properties &props, const string &file_name,
+                DB *db) {
+  const int all_cpus = seastar::smp::all_cpus().size();
+  const double interval = stod(props.GetProperty("status.interval", "10"));
+  Probes probes = OpenProbes(props);
+
+  if (stoi(props.GetProperty("init_data", "1"))) {
+    CoreWorkload wl;
+    wl.Init(props);
+    LoadPhase(props, file_name, db, wl, probes);
+  }
+
+  vector<std::unique_ptr<Tenant>> tenants;
+  for (const string &workload : SplitList(props["tenants"])) {
+    auto tenant = std::make_unique<Tenant>();
+    tenant->props = props;
+    ifstream input(workload);
+    tenant->props.Load(input);
+    ApplyPlacement(tenant->props);
+    tenant->name = tenant->props.GetProperty("tenant.name", workload);
+    tenant->wl.Init(tenant->props);
+    tenant->placement = ClientPlacement(tenant->props);
+    tenant->num_threads = tenant->placement.num_clients;
+    tenant->total_ops =
+        stoi(tenant->props[CoreWorkload::OPERATION_COUNT_PROPERTY]);
+    tenant->queue_depth = stoi(tenant->props.GetProperty("queuedepth", "1"));
+    tenant->target = stod(tenant->props.GetProperty("target", "0"));
+    tenant->max_outstanding =
+        stoi(tenant->props.GetProperty("openloop.max_outstanding", "1024"));
+    const double shares =
+        stod(tenant->props.GetProperty("tenant.shares", "0"));
+    if (shares > 0) {
+      tenant->group = seastar::create_scheduling_group(
+          "tenant" + to_string(tenants.size()), shares).get();
+    }
+    tenant->latency.resize(tenant->num_threads);
+    tenant->progress = vector<Progress>(tenant->num_threads);
+    for (int i = 0; i < tenant->num_threads; ++i) {
+      tenant->progress[i].group = tenant->placement.ShardOf(i);
+    }
+    tenants.push_back(std::move(tenant));
+  }
+  if (tenants.empty()) {
+    throw utils::Exception("No workloads in tenants: " + props["tenants"]);
+  }
+
+  std::cout << "=============================== Tenants "
+               "==============================="
+            << std::endl;
+  vector<std::unique_ptr<StatusReporter>> status;
+  for (auto &tenant : tenants) {
+    status.push_back(std::make_unique<StatusReporter>(
+        tenant->name, tenant->progress, all_cpus, interval));
+  }
+  probes.Start();
+  vector<seastar::future<>> running;
+  for (auto &tenant : tenants) {
+    running.push_back(seastar::async([t = tenant.get(), db,
+                                      pr = &probes] {
+      utils::Timer<double> timer;
+      timer.Start();
+      vector<seastar::future<int>> clients;
+      for (int i = 0; i < t->num_threads; ++i) {
+        clients.push_back(seastar::smp::submit_to(
+            t->placement.ShardOf(i),
+            [t, db, i, ops = utils::ShareOf(t->total_ops, t->num_threads, i),
+             rate = t->target / t->num_threads, pr] {
+              auto run = [t, db, i, ops, rate, pr] {
+                return seastar::async([t, db, i, ops, rate, pr] {
+                  if (rate > 0) {
+                    return OpenLoopClient(db, &t->wl, ops, &t->latency[i], i,
+                                          &t->progress[i], rate,
+                                          t->max_outstanding, pr);
+                  }
+                  return DelegateClient(db, &t->wl, ops, false,
+                                        &t->latency[i], i, &t->progress[i],
+                                        t->queue_depth, pr);
+                });
+              };
+              if (t->group) {
+                return seastar::with_scheduling_group(*t->group, run);
+              }
+              return run();
+            }));
+      }
+      for (auto &n : clients) t->oks += n.get();
+      t->seconds = timer.End();
+    }));
+  }
+  for (auto &f : running) f.get();
+  probes.Stop();
+  status.clear();
+
+  vector<int> clients(all_cpus);
+  uint64_t total_ops = 0;
+  double seconds = 0;
+  vector<PhaseResult> results;
+  for (auto &tenant : tenants) {
+    PhaseResult result;
+    result.ops = tenant->total_ops;
+    result.oks = tenant->oks;
+    result.seconds = tenant->seconds;
+    result.ktps = tenant->total_ops / tenant->seconds / 1000;
+    cout << "# " << tenant->name << " throughput (KTPS)" << endl;
+    cout << tenant->name << '\t' << tenant->num_threads << '\t'
+         << result.ktps << endl;
+    ReportLatency(tenant->name, tenant->latency, result);
+    tenant->wl.ReportFieldLengths(cout);
+    results.push_back(std::move(result));
+    vector<int> tenant_clients = tenant->placement.Clients();
+    for (int s = 0; s < all_cpus; ++s) clients[s] += tenant_clients[s];
+    total_ops += tenant->total_ops;
+    seconds = std::max(seconds, tenant->seconds);
+  }
+  probes.Report("Tenants", total_ops, clients, seconds);
+
+  cout << "# Tenant results" << endl;
+  cout << "tenant\tthreads\tshares\ttarget\tKTPS\tavg ms\tp99 ms"
+          "\tp99.9 ms"
+       << endl;
+  for (size_t i = 0; i < tenants.size(); ++i) {
+    const Tenant &tenant = *tenants[i];
+    const PhaseResult &result = results[i];
+    cout << tenant.name << '\t' << tenant.num_threads << '\t'
+         << tenant.props.GetProperty("tenant.shares", "-") << '\t'
+         << tenant.target << '\t' << result.ktps << '\t' << result.avg_ms
+         << '\t' << result.p99_ms << '\t' << result.p999_ms << endl;
+  }
+
+  for (auto &tenant : tenants) {
+    if (tenant->group) seastar::destroy_scheduling_group(*tenant->group).get();
+  }
+}
+
+void RunBench(const utils::Properties &bench_props, const string &file_name,
+              DB *db) {
+  if (!bench_props.GetProperty("slaves").empty()) {
+    RunCoordinator(bench_props, file_name);
+    return;
+  }
+  utils::Properties props = bench_props;
+  ApplyPlacement(props);
+  std::unique_ptr<DB> forwarding;
+  if (!props.GetProperty("engine.shards").empty()) {
+    forwarding.reset(
+        new ForwardingDB(db, ParseShards(props["engine.shards"])));
+    db = forwarding.get();
+  }
+  if (!props.GetProperty("host").empty()) {
+    RunWorker(props, db);
+    return;
+  }
+  if (!props.GetProperty("sweep").empty()) {
+    RunSweep(props, file_name, db);
+    return;
+  }
+  if (!props.GetProperty("tenants").empty()) {
+    RunTenants(props, file_name, db);
+    return;
+  }
+  if (props.GetProperty("search") == "true") {
+    RunSearch(props, file_name, db);
+    return;
+  }
+
+  CoreWorkload wl;
+  wl.Init(props);
+  Probes probes = OpenProbes(props);
+
+  if (stoi(props.GetProperty("init_data", "1"))) {  // Loads data
+    LoadPhase(props, file_name, db, wl, probes);
+  }
+  WarmUp(props, file_name, db, wl, probes);
+  TransactionPhase(props, file_name, db, wl, probes);
 }
 }  // namespace ycsbc
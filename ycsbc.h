@@ -1,9 +1,20 @@
 #pragma once
 
+#include <string>
+
 #include "core/core_workload.h"
 #include "core/db.h"
+#include "core/properties.h"
 
 namespace ycsbc {
 
+///
+/// Parses ycsbc options into props and returns the last property file name.
+///
+std::string ParseCommandLine(int argc, const char* argv[],
+                             utils::Properties& props);
+
 void RunBench(int argc, const char* argv[], DB* db);
+void RunBench(const utils::Properties& props, const std::string& file_name,
+              DB* db);
 }
@@ -0,0 +1,65 @@
+#include "ycsbc.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "db/db_factory.h"
+
+#include <seastar/core/app-template.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/thread.hh>
+
+int main(int argc, char *argv[]) {
+
+  using namespace std::string_literals;
+
+  std::vector<char *> seastar_args, ycsbc_args;
+
+  seastar_args.push_back(argv[0]);
+  ycsbc_args.push_back(argv[0]);
+
+  {
+    bool sep_met = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+      if (argv[i] == "--"s) {
+        sep_met = true;
+      }
+      else if (sep_met) {
+        ycsbc_args.push_back(argv[i]);
+      }
+      else {
+        seastar_args.push_back(argv[i]);
+      }
+    }
+
+    if (!sep_met) {
+      std::cerr << "Usage: " << argv[0] << " <seastar args> -- <ycsbc args>" << std::endl;
+      return 1;
+    }
+  }
+
+  seastar::app_template app;
+  return app.run(seastar_args.size(), seastar_args.data(), [ycsbc_args] {
+    return seastar::async([ycsbc_args]() mutable -> void {
+      utils::Properties props;
+      std::string file_name = ycsbc::ParseCommandLine(
+          ycsbc_args.size(), const_cast<const char **>(ycsbc_args.data()),
+          props);
+
+      // A coordinator only drives its workers' DBs.
+      const bool coordinator = !props.GetProperty("slaves").empty();
+      ycsbc::DB *db = coordinator ? NULL : ycsbc::DBFactory::CreateDB(props);
+      if (!db && !coordinator) {
+        std::cerr << "Unknown database name " << props.GetProperty("dbname")
+                  << std::endl;
+        return;
+      }
+      ycsbc::RunBench(props, file_name, db);
+      delete db;
+    });
+  });
+}